@@ -0,0 +1,131 @@
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// Micro-benchmark of the ThreadPool schedulers.
+//   ./bench [max_threads] [tasks]
+// Throughput, tasks per second at 1..N threads:
+//   external: the main thread enqueues every task, so all of them pass the shared (injection) queue
+//   spawned : one root job per worker enqueues the tasks from inside the pool, like jobs that
+//             split their own work (per-tile alignment, recursive matrix blocks)
+// Latency, enqueue until the job starts, one job in flight at a time:
+//   hot : jobs back to back, so an idle worker has only just run out of work
+//   cold: 1 ms pause before each job, so every worker is asleep (parked) when it arrives
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<size_t> done(0);
+
+void tiny_task() {
+    done.fetch_add(1, std::memory_order_relaxed);
+}
+
+double run(ThreadPool::Scheduler scheduler, size_t threads, size_t tasks, bool spawned) {
+    done = 0;
+    // the pool reports its thread times on destruction; keep them out of the table
+    std::ostringstream sink;
+    std::streambuf* out = std::cout.rdbuf();
+
+    double seconds;
+    {
+        ThreadPool pool(threads, scheduler);
+        auto start = std::chrono::high_resolution_clock::now();
+        if (spawned) {
+            size_t per_root = tasks / threads;
+            for (size_t r = 0; r < threads; ++r) {
+                size_t count = r + 1 < threads ? per_root : tasks - per_root * (threads - 1);
+                pool.enqueue([&pool, count] {
+                    for (size_t k = 0; k < count; ++k)
+                        pool.enqueue(tiny_task);
+                });
+            }
+        } else {
+            for (size_t k = 0; k < tasks; ++k)
+                pool.enqueue(tiny_task);
+        }
+        pool.wait_all();
+        auto end = std::chrono::high_resolution_clock::now();
+        seconds = std::chrono::duration<double>(end - start).count();
+        std::cout.rdbuf(sink.rdbuf());
+    }
+    std::cout.rdbuf(out);
+    return tasks / seconds;
+}
+
+struct Latency {
+    double median;
+    double p99;
+};
+
+// microseconds from enqueue() to the job's first instruction
+Latency latency(ThreadPool::Scheduler scheduler, size_t threads, size_t samples, bool cold) {
+    std::ostringstream sink;
+    std::streambuf* out = std::cout.rdbuf();
+    std::vector<double> us(samples);
+    {
+        ThreadPool pool(threads, scheduler);
+        std::atomic<bool> ran(false);
+        for (size_t k = 0; k < samples; ++k) {
+            if (cold) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            ran.store(false, std::memory_order_relaxed);
+            Clock::time_point start = Clock::now();
+            pool.enqueue([&us, &ran, start, k] {
+                us[k] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                ran.store(true, std::memory_order_release);
+            });
+            while (!ran.load(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+        pool.wait_all();
+        std::cout.rdbuf(sink.rdbuf());
+    }
+    std::cout.rdbuf(out);
+    std::sort(us.begin(), us.end());
+    return {us[samples / 2], us[samples * 99 / 100]};
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    size_t tasks = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    if (max_threads == 0) max_threads = 1;
+
+    std::cout << tasks << " tasks, million tasks per second\n";
+    const ThreadPool::Scheduler schedulers[] = {
+        ThreadPool::Scheduler::SharedQueue, ThreadPool::Scheduler::WorkStealing, ThreadPool::Scheduler::BoundedRing
+    };
+    const char* names[] = {"shared", "stealing", "ring"};
+
+    std::cout << "threads  external:shared  external:stealing  external:ring"
+                 "  spawned:shared  spawned:stealing  spawned:ring\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t t = 1; t <= max_threads; ++t) {
+        // measured first: the pools print to std::cout, which would eat a pending setw
+        double rates[6];
+        for (int s = 0; s < 3; ++s) {
+            rates[s] = run(schedulers[s], t, tasks, false);
+            rates[3 + s] = run(schedulers[s], t, tasks, true);
+        }
+        std::cout << std::setw(7) << t
+                  << std::setw(17) << rates[0] / 1e6 << std::setw(19) << rates[1] / 1e6
+                  << std::setw(15) << rates[2] / 1e6 << std::setw(16) << rates[3] / 1e6
+                  << std::setw(18) << rates[4] / 1e6 << std::setw(14) << rates[5] / 1e6 << "\n";
+    }
+
+    std::cout << "\nwake-up latency, " << max_threads << " threads, microseconds (median / p99)\n";
+    std::cout << "scheduler          hot               cold\n";
+    for (int s = 0; s < 3; ++s) {
+        Latency hot = latency(schedulers[s], max_threads, 20000, false);
+        Latency cold = latency(schedulers[s], max_threads, 500, true);
+        std::cout << std::left << std::setw(9) << names[s] << std::right
+                  << std::setw(9) << hot.median << " /" << std::setw(7) << hot.p99
+                  << std::setw(10) << cold.median << " /" << std::setw(7) << cold.p99 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef EVENT_COUNT_HPP
+#define EVENT_COUNT_HPP
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Sleep while `word` still holds `expected` (may return spuriously), and wake sleepers on `word`.
+// A futex on Linux (C++17 has no std::atomic::wait), a yield loop elsewhere.
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) {
+#ifdef __linux__
+    if (word.load(std::memory_order_acquire) == expected)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    while (word.load(std::memory_order_acquire) == expected)
+        std::this_thread::yield();
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t>& word, int count) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+    (void)word;
+    (void)count;
+#endif
+}
+
+// Lets a thread sleep until "something changed" without a mutex (an event count).
+//   waiter:   key = prepare_wait(); re-check the condition;
+//             then cancel_wait() if it holds, or commit_wait(key) to sleep
+//   notifier: make the condition true, then notify_one() / notify_all()
+// The waiter announces itself before its re-check and the notifier publishes before it looks
+// for waiters (both sequentially consistent), so either the re-check sees the change or the
+// notifier sees the waiter and bumps the epoch, which a sleeper on the old key wakes up for.
+// A notify with nobody waiting is one fence and one load.
+class EventCount {
+public:
+    uint32_t prepare_wait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_seq_cst);
+    }
+
+    void cancel_wait() {
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // may return spuriously; the caller re-checks its condition anyway
+    void commit_wait(uint32_t key) {
+        futex_wait(epoch, key);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notify_one() { notify(1); }
+    void notify_all() { notify(INT_MAX); }
+
+private:
+    void notify(int count) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+            return;
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        futex_wake(epoch, count);
+    }
+
+    std::atomic<uint32_t> epoch{0};
+    std::atomic<uint32_t> waiters{0};
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "gemm.hpp"
+#include "matrix_storage.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEMM_X86 1
+#endif
+
+namespace {
+
+// Cache blocking (Goto & van de Geijn, "Anatomy of High-Performance Matrix Multiplication"):
+//   KC  depth of one rank-KC update: an MR x KC sliver of A plus a KC x NR sliver of B fit in L1
+//   MC  rows of the packed MC x KC block of A, which stays in L2 across a whole B panel
+//   NC  columns of the packed KC x NC panel of B, which stays in L3 across all blocks of A
+constexpr int KC = 256;
+constexpr int MC = 144;
+constexpr int NC = 4096;
+
+// Register tile of the micro-kernel for vectors of `Bytes` bytes: MR rows by two vectors.
+// 2 * MR accumulators plus two B vectors and one broadcast A value fit in the 16 (32 with
+// AVX-512) vector registers.
+template <typename T, int Bytes>
+struct Tile {
+    static constexpr int VW = Bytes / static_cast<int>(sizeof(T));
+    static constexpr int MR = Bytes == 64 ? 12 : 6;
+    static constexpr int NR = 2 * VW;
+};
+
+// ab (MR x NR, row by row) = a * b, for a packed MR x kc sliver a (MR values per step of k)
+// and a packed kc x NR sliver b (NR values per step of k).
+template <typename T, int Bytes>
+inline __attribute__((always_inline)) void micro_kernel(int kc, const T* a, const T* b, T* ab) {
+    using Tl = Tile<T, Bytes>;
+    typedef T V __attribute__((vector_size(Bytes)));
+
+    V c0[Tl::MR], c1[Tl::MR];
+#pragma GCC unroll 16
+    for (int r = 0; r < Tl::MR; ++r)
+        c0[r] = c1[r] = V{};
+
+    for (int p = 0; p < kc; ++p) {
+        V b0, b1;
+        std::memcpy(&b0, b, Bytes);
+        std::memcpy(&b1, b + Tl::VW, Bytes);
+#pragma GCC unroll 16
+        for (int r = 0; r < Tl::MR; ++r) {
+            V ar = a[r] + V{};   // broadcast
+            c0[r] += ar * b0;
+            c1[r] += ar * b1;
+        }
+        a += Tl::MR;
+        b += Tl::NR;
+    }
+
+#pragma GCC unroll 16
+    for (int r = 0; r < Tl::MR; ++r) {
+        std::memcpy(ab + r * Tl::NR, &c0[r], Bytes);
+        std::memcpy(ab + r * Tl::NR + Tl::VW, &c1[r], Bytes);
+    }
+}
+
+// One instance per instruction set; the vector code is only generated for the target named.
+template <typename T>
+void micro_128(int kc, const T* a, const T* b, T* ab) { micro_kernel<T, 16>(kc, a, b, ab); }
+
+#ifdef GEMM_X86
+template <typename T>
+__attribute__((target("avx2,fma")))
+void micro_256(int kc, const T* a, const T* b, T* ab) { micro_kernel<T, 32>(kc, a, b, ab); }
+
+template <typename T>
+__attribute__((target("avx512f")))
+void micro_512(int kc, const T* a, const T* b, T* ab) { micro_kernel<T, 64>(kc, a, b, ab); }
+#endif
+
+// The rows x cols block at X (strides rs, cs) as slivers of R rows: sliver s holds rows
+// s * R ... s * R + R - 1, column by column. Missing rows of the last sliver are zero.
+// Packing A uses R = MR; packing B uses its transpose with R = NR.
+template <int R, typename T>
+void pack(int rows, int cols, const T* X, std::ptrdiff_t rs, std::ptrdiff_t cs, T* out) {
+    for (int i = 0; i < rows; i += R) {
+        int r_end = std::min(R, rows - i);
+        const T* x = X + i * rs;
+        for (int p = 0; p < cols; ++p) {
+            const T* col = x + p * cs;
+            int r = 0;
+            for (; r < r_end; ++r)
+                out[r] = col[r * rs];
+            for (; r < R; ++r)
+                out[r] = T(0);
+            out += R;
+        }
+    }
+}
+
+// Write (first rank-KC update) or accumulate the top-left mr x nr corner of the tile ab.
+template <typename T>
+void update_tile(int mr, int nr, const T* ab, int ld_ab,
+                 T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc, bool first) {
+    if (csc == 1) {
+        for (int i = 0; i < mr; ++i) {
+            T* c = C + i * rsc;
+            const T* t = ab + i * ld_ab;
+            if (first) std::copy(t, t + nr, c);
+            else for (int j = 0; j < nr; ++j) c[j] += t[j];
+        }
+    } else {
+        for (int j = 0; j < nr; ++j) {
+            T* c = C + j * csc;
+            for (int i = 0; i < mr; ++i)
+                c[i * rsc] = first ? ab[i * ld_ab + j] : c[i * rsc] + ab[i * ld_ab + j];
+        }
+    }
+}
+
+template <typename T, int Bytes, void (*Micro)(int, const T*, const T*, T*)>
+void gemm_blocked(int m, int n, int k,
+                  const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                  const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                  T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc) {
+    constexpr int MR = Tile<T, Bytes>::MR;
+    constexpr int NR = Tile<T, Bytes>::NR;
+
+    const int kc_max = std::min(KC, k);
+    const int mc_max = std::min(MC, (m + MR - 1) / MR * MR);
+    const int nc_max = std::min(NC, (n + NR - 1) / NR * NR);
+    Aligned_Buffer<T> a_pack(static_cast<size_t>(mc_max) * kc_max, no_init);
+    Aligned_Buffer<T> b_pack(static_cast<size_t>(kc_max) * nc_max, no_init);
+    alignas(kMatrixAlign) T ab[MR * NR];
+
+    for (int jc = 0; jc < n; jc += NC) {
+        int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            int kc = std::min(KC, k - pc);
+            // B^T is packed like A: NR "rows" of B^T are NR columns of B
+            pack<NR>(nc, kc, B + pc * rsb + jc * csb, csb, rsb, b_pack.data());
+
+            for (int ic = 0; ic < m; ic += MC) {
+                int mc = std::min(MC, m - ic);
+                pack<MR>(mc, kc, A + ic * rsa + pc * csa, rsa, csa, a_pack.data());
+
+                for (int jr = 0; jr < nc; jr += NR) {
+                    const T* b = b_pack.data() + jr * kc;
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        Micro(kc, a_pack.data() + ir * kc, b, ab);
+                        update_tile(std::min(MR, mc - ir), std::min(NR, nc - jr), ab, NR,
+                                    C + (ic + ir) * rsc + (jc + jr) * csc, rsc, csc, pc == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+enum class Isa { V128, AVX2, AVX512 };
+
+Isa detect_isa() {
+#ifdef GEMM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+    // micro_256 is built for avx2 and fma, and a few CPUs (and VMs) report one without the other
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::AVX2;
+#endif
+    return Isa::V128;
+}
+
+} // namespace
+
+template <typename T>
+void gemm(int m, int n, int k,
+          const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+          const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+          T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc) {
+    if (m <= 0 || n <= 0)
+        return;
+    if (k <= 0) {   // empty sum
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j)
+                C[i * rsc + j * csc] = T(0);
+        return;
+    }
+
+    static const Isa isa = detect_isa();
+    switch (isa) {
+#ifdef GEMM_X86
+    case Isa::AVX512:
+        return gemm_blocked<T, 64, micro_512<T>>(m, n, k, A, rsa, csa, B, rsb, csb, C, rsc, csc);
+    case Isa::AVX2:
+        return gemm_blocked<T, 32, micro_256<T>>(m, n, k, A, rsa, csa, B, rsb, csb, C, rsc, csc);
+#endif
+    default:
+        return gemm_blocked<T, 16, micro_128<T>>(m, n, k, A, rsa, csa, B, rsb, csb, C, rsc, csc);
+    }
+}
+
+// Explicit instantiation
+template void gemm<int>(int, int, int, const int*, std::ptrdiff_t, std::ptrdiff_t,
+                        const int*, std::ptrdiff_t, std::ptrdiff_t, int*, std::ptrdiff_t, std::ptrdiff_t);
+template void gemm<float>(int, int, int, const float*, std::ptrdiff_t, std::ptrdiff_t,
+                          const float*, std::ptrdiff_t, std::ptrdiff_t, float*, std::ptrdiff_t, std::ptrdiff_t);
+template void gemm<double>(int, int, int, const double*, std::ptrdiff_t, std::ptrdiff_t,
+                           const double*, std::ptrdiff_t, std::ptrdiff_t, double*, std::ptrdiff_t, std::ptrdiff_t);
@@ -0,0 +1,21 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include <cstddef>
+
+// C = A * B, for an m x k matrix A and a k x n matrix B. Every operand is given by its first
+// element and its row and column strides: element (i, j) of A is A[i * rsa + j * csa]. One
+// kernel therefore serves row-major and column-major operands alike (and sub-matrices of them).
+// C is overwritten, never read, and must not overlap A or B.
+//
+// Goto / BLIS structure: B is packed one KC x NC panel at a time (kept in L3), A one MC x KC
+// block at a time (kept in L2), and a SIMD micro-kernel multiplies an MR x KC sliver of A by a
+// KC x NR sliver of B (both in L1) into an MR x NR tile of registers. The micro-kernel is picked
+// once at run time: AVX-512, AVX2 or 128-bit vectors. Instantiated for int, float and double.
+template <typename T>
+void gemm(int m, int n, int k,
+          const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+          const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+          T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc);
+
+#endif // GEMM_HPP
@@ -3,17 +3,19 @@
 #include <vector>
 #include <cassert>
 #include <numeric>  // std::iota
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <thread>
 
 // Auxiliary function: compare two Row_Major_Matrix for equality
 template<typename T>
 bool areRowMatricesEqual(const Row_Major_Matrix<T>& m1, const Row_Major_Matrix<T>& m2) {
-    if (m1.all_row.size() != m2.all_row.size())
+    if (m1.rows() != m2.rows() || m1.cols() != m2.cols())
         return false;
-    for (size_t i = 0; i < m1.all_row.size(); ++i) {
-        if (m1.all_row[i].size() != m2.all_row[i].size())
-            return false;
-        for (size_t j = 0; j < m1.all_row[i].size(); ++j) {
-            if (m1.all_row[i][j] != m2.all_row[i][j])
+    for (int i = 0; i < m1.rows(); ++i) {
+        for (int j = 0; j < m1.cols(); ++j) {
+            if (m1(i, j) != m2(i, j))
                 return false;
         }
     }
@@ -23,19 +25,165 @@ bool areRowMatricesEqual(const Row_Major_Matrix<T>& m1, const Row_Major_Matrix<T
 // Auxiliary function: compare two Column_Major_Matrix for equality
 template<typename T>
 bool areColMatricesEqual(const Column_Major_Matrix<T>& m1, const Column_Major_Matrix<T>& m2) {
-    if (m1.all_column.size() != m2.all_column.size())
+    if (m1.rows() != m2.rows() || m1.cols() != m2.cols())
         return false;
-    for (size_t i = 0; i < m1.all_column.size(); ++i) {
-        if (m1.all_column[i].size() != m2.all_column[i].size())
-            return false;
-        for (size_t j = 0; j < m1.all_column[i].size(); ++j) {
-            if (m1.all_column[i][j] != m2.all_column[i][j])
+    for (int j = 0; j < m1.cols(); ++j) {
+        for (int i = 0; i < m1.rows(); ++i) {
+            if (m1(i, j) != m2(i, j))
                 return false;
         }
     }
     return true;
 }
 
+// Auxiliary function: the same matrix in the two layouts
+template<typename T>
+bool sameMatrix(const Row_Major_Matrix<T>& rm, const Column_Major_Matrix<T>& cm) {
+    if (rm.rows() != cm.rows() || rm.cols() != cm.cols())
+        return false;
+    for (int i = 0; i < rm.rows(); ++i)
+        for (int j = 0; j < rm.cols(); ++j)
+            if (rm(i, j) != cm(i, j))
+                return false;
+    return true;
+}
+
+// Auxiliary function: c == a * b against a plain triple loop in double, up to a relative error
+template<typename T>
+bool isProduct(const Row_Major_Matrix<T>& a, const Row_Major_Matrix<T>& b, const Row_Major_Matrix<T>& c, double tol) {
+    for (int i = 0; i < c.rows(); ++i)
+        for (int j = 0; j < c.cols(); ++j) {
+            double sum = 0;
+            for (int k = 0; k < a.cols(); ++k)
+                sum += static_cast<double>(a(i, k)) * b(k, j);
+            if (std::abs(c(i, j) - sum) > tol * std::abs(sum))
+                return false;
+        }
+    return true;
+}
+
+// The blocked kernel at sizes that are not multiples of its tiles, in both operator combinations
+template<typename T>
+void test_blocked_multiplication(double tol) {
+    Row_Major_Matrix<T> a(131, 300);
+    Column_Major_Matrix<T> b(300, 67);
+    Row_Major_Matrix<T> c = a * b;
+    assert(c.rows() == 131 && c.cols() == 67);
+    assert(isProduct(a, Row_Major_Matrix<T>(b), c, tol) && "Row Major * Column Major product is wrong");
+
+    Column_Major_Matrix<T> d(67, 300);
+    Row_Major_Matrix<T> f(300, 131);
+    Column_Major_Matrix<T> g = d * f;
+    assert(g.rows() == 67 && g.cols() == 131);
+    assert(isProduct(Row_Major_Matrix<T>(d), f, Row_Major_Matrix<T>(g), tol) && "Column Major * Row Major product is wrong");
+}
+
+// operator% on the shared pool against operator*, for shapes with fewer rows (or columns) than
+// threads, and for a few pool sizes; the padding of the result must come out zero
+void test_parallel_multiplication() {
+    const int shapes[][3] = {{3, 500, 700}, {300, 200, 257}, {517, 64, 2}};
+    for (size_t threads : {size_t(1), size_t(3), size_t(0)}) {
+        set_matrix_threads(threads);
+        assert(matrix_threads() == (threads ? threads : std::max(1u, std::thread::hardware_concurrency())));
+        for (const auto& s : shapes) {
+            Row_Major_Matrix<int> a(s[0], s[1]);
+            Column_Major_Matrix<int> b(s[1], s[2]);
+            Row_Major_Matrix<int> c = a % b;
+            assert(areRowMatricesEqual(c, a * b) && "Row Major % differs from *");
+            for (int i = 0; i < c.rows(); ++i)
+                for (size_t j = c.cols(); j < c.ld(); ++j)
+                    assert(c.data()[i * c.ld() + j] == 0 && "Row Major % left padding unset");
+
+            Column_Major_Matrix<int> d(s[2], s[0]);
+            Row_Major_Matrix<int> e(s[0], s[1]);
+            Column_Major_Matrix<int> f = d % e;
+            assert(areColMatricesEqual(f, d * e) && "Column Major % differs from *");
+            for (int j = 0; j < f.cols(); ++j)
+                for (size_t i = f.rows(); i < f.ld(); ++i)
+                    assert(f.data()[j * f.ld() + i] == 0 && "Column Major % left padding unset");
+        }
+    }
+    set_matrix_threads(0);
+}
+
+// strassen() against operator*, with small cutoffs so that the recursion, the peeling of odd
+// sizes and (with 3 threads) the parallel levels all run; int products must match exactly
+void test_strassen_multiplication() {
+    const int shapes[][3] = {{128, 128, 128}, {131, 97, 203}, {200, 3, 150}};
+    for (size_t threads : {size_t(1), size_t(3)}) {
+        set_matrix_threads(threads);
+        for (const auto& s : shapes)
+            for (int cutoff : {1, 16, 40}) {
+                Row_Major_Matrix<int> a(s[0], s[1]);
+                Column_Major_Matrix<int> b(s[1], s[2]);
+                assert(areRowMatricesEqual(a.strassen(b, cutoff), a * b) && "Row Major Strassen differs from *");
+
+                Column_Major_Matrix<int> d(s[2], s[0]);
+                Row_Major_Matrix<int> e(s[0], s[1]);
+                assert(areColMatricesEqual(d.strassen(e, cutoff), d * e) && "Column Major Strassen differs from *");
+            }
+    }
+    set_matrix_threads(0);
+
+    // floating point: close to the plain triple loop, not equal
+    Row_Major_Matrix<double> a(150, 150);
+    Column_Major_Matrix<double> b(150, 150);
+    assert(isProduct(a, Row_Major_Matrix<double>(b), a.strassen(b, 16), 1e-10) && "double Strassen is off");
+}
+
+// Layout conversions and in-place transposes, for sizes that are and are not multiples of the
+// transpose blocks; padding must stay zero
+template<typename T>
+void test_transpose() {
+    const int shapes[][2] = {{1, 1}, {3, 70}, {37, 5}, {64, 64}, {67, 131}};
+    for (const auto& s : shapes) {
+        Row_Major_Matrix<T> a(s[0], s[1]);
+        Column_Major_Matrix<T> b = a;
+        assert(sameMatrix(a, b) && "Row -> Column conversion failed!");
+        for (int j = 0; j < b.cols(); ++j)
+            for (size_t i = b.rows(); i < b.ld(); ++i)
+                assert(b.data()[j * b.ld() + i] == 0 && "Row -> Column conversion left padding unset");
+        Row_Major_Matrix<T> c = b;
+        assert(areRowMatricesEqual(a, c) && "Column -> Row conversion failed!");
+        for (int i = 0; i < c.rows(); ++i)
+            for (size_t j = c.cols(); j < c.ld(); ++j)
+                assert(c.data()[i * c.ld() + j] == 0 && "Column -> Row conversion left padding unset");
+    }
+
+    for (int n : {1, 3, 8, 67, 128}) {
+        Row_Major_Matrix<T> a(n, n);
+        Row_Major_Matrix<T> at = a;
+        at.transpose_in_place();
+        Column_Major_Matrix<T> b(n, n);
+        Column_Major_Matrix<T> bt = b;
+        bt.transpose_in_place();
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) {
+                assert(at(i, j) == a(j, i) && "Row Major in-place transpose failed!");
+                assert(bt(i, j) == b(j, i) && "Column Major in-place transpose failed!");
+            }
+        for (int i = 0; i < n; ++i)
+            for (size_t j = n; j < at.ld(); ++j)
+                assert(at.data()[i * at.ld() + j] == 0 && bt.data()[i * bt.ld() + j] == 0
+                       && "in-place transpose touched the padding");
+    }
+
+    bool thrown = false;
+    try {
+        Row_Major_Matrix<T>(3, 4).transpose_in_place();
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown && "in-place transpose accepted a non-square matrix");
+
+    // storage only: every element written through data() and ld()
+    Row_Major_Matrix<T> d(5, 7, no_init);
+    assert(d.rows() == 5 && d.cols() == 7 && d.ld() >= 7);
+    for (int i = 0; i < d.rows(); ++i)
+        std::fill(d.data() + i * d.ld(), d.data() + (i + 1) * d.ld(), T(i));
+    assert(d(4, 6) == T(4));
+}
+
 void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10, int CM_cols = 10) {
     std::cout << "===== Testing Matrix Operations =====" << std::endl;
 
@@ -68,8 +216,8 @@ void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10
     Column_Major_Matrix<int> colMoved(std::move(colCopy));
     assert(areRowMatricesEqual(rowMatrix, rowMoved) && "Row Major Matrix move assignment failed!");
     assert(areColMatricesEqual(colMatrix, colMoved) && "Column Major Matrix move assignment failed!");
-    assert(rowCopy.all_row.empty() && "Row Major Matrix copy should be empty after move assignment");
-    assert(colCopy.all_column.empty() && "Col Major Matrix copy should be empty after move assignment");
+    assert(rowCopy.empty() && "Row Major Matrix copy should be empty after move assignment");
+    assert(colCopy.empty() && "Col Major Matrix copy should be empty after move assignment");
     std::cout << "✅ Move assignment test1 passed!" << std::endl;
 
     // Test move assignment2
@@ -77,8 +225,8 @@ void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10
     Column_Major_Matrix<int> colMoveAssigned = std::move(colAssigned);
     assert(areRowMatricesEqual(rowMatrix, rowMoveAssigned));
     assert(areColMatricesEqual(colMatrix, colMoveAssigned));
-    assert(rowAssigned.all_row.empty() && "rowAssigned should be empty");
-    assert(colAssigned.all_column.empty() && "colAssigned should be empty");
+    assert(rowAssigned.empty() && "rowAssigned should be empty");
+    assert(colAssigned.empty() && "colAssigned should be empty");
     std::cout << "✅ Move assignment test2 passed!" << std::endl;
 
     // Test getter / setter for Row Major Matrix
@@ -92,6 +240,13 @@ void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10
     // }
     std::cout << "\n✅ Getter / Setter test for Row Major Matrix passed!" << std::endl;
 
+    // Test that rows and columns are views into the storage, not copies
+    rowMatrix.getRow(1)[2] = -7;
+    assert(rowMatrix(1, 2) == -7 && rowMatrix.columnView(2)[1] == -7 && "Row view should alias the matrix");
+    assert(rowMatrix.getRow(1).data() == rowMatrix.data() + rowMatrix.ld() && "getRow should not copy");
+    assert(reinterpret_cast<uintptr_t>(rowMatrix.getRow(1).data()) % kMatrixAlign == 0 && "rows should be aligned");
+    std::cout << "✅ Row view test passed!" << std::endl;
+
     // Test getter / setter for Column Major Matrix
     std::vector<int> newCol(CM_rows);
     std::iota(newCol.begin(), newCol.end(), 1);
@@ -103,6 +258,12 @@ void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10
     // }
     std::cout << "\n✅ Getter / Setter test for Column Major Matrix passed!" << std::endl;
 
+    colMatrix.getColumn(1)[2] = -7;
+    assert(colMatrix(2, 1) == -7 && colMatrix.rowView(2)[1] == -7 && "Column view should alias the matrix");
+    assert(colMatrix.getColumn(1).data() == colMatrix.data() + colMatrix.ld() && "getColumn should not copy");
+    assert(reinterpret_cast<uintptr_t>(colMatrix.getColumn(1).data()) % kMatrixAlign == 0 && "columns should be aligned");
+    std::cout << "✅ Column view test passed!" << std::endl;
+
     // Single-threaded matrix multiplication: Row Major * Column Major
     std::cout << "\n=== Row Major * Column Major (Single-threaded) ===" << std::endl;
     Row_Major_Matrix<int> result1 = rowMatrix * colMatrix;
@@ -137,13 +298,39 @@ void test_matrix_operations(int RM_rows = 10, int RM_cols = 10, int CM_rows = 10
     // Test type conversion: Row Major -> Column Major
     std::cout << "\n=== Type Conversion: Row Major -> Column Major ===" << std::endl;
     Column_Major_Matrix<int> convertedCol = rowMatrix;
+    assert(sameMatrix(rowMatrix, convertedCol) && "Row -> Column conversion failed!");
     // convertedCol.print();
 
     // Test type conversion: Column Major -> Row Major
     std::cout << "\n=== Type Conversion: Column Major -> Row Major ===" << std::endl;
     Row_Major_Matrix<int> convertedRow = colMatrix;
+    assert(sameMatrix(convertedRow, colMatrix) && "Column -> Row conversion failed!");
     // convertedRow.print();
 
+    // Test the blocked conversions and in-place transposes for every element type
+    std::cout << "\n=== Transpose: conversions and in place, int, float, double ===" << std::endl;
+    test_transpose<int>();
+    test_transpose<float>();
+    test_transpose<double>();
+    std::cout << "✅ Transpose test passed!" << std::endl;
+
+    // Test the blocked kernel for every element type
+    std::cout << "\n=== Blocked multiplication: int, float, double ===" << std::endl;
+    test_blocked_multiplication<int>(0);
+    test_blocked_multiplication<float>(1e-5);
+    test_blocked_multiplication<double>(1e-12);
+    std::cout << "✅ Blocked multiplication test passed!" << std::endl;
+
+    // Test the multi-threaded multiplication on pools of different sizes
+    std::cout << "\n=== Multi-threaded multiplication: tiles and pool sizes ===" << std::endl;
+    test_parallel_multiplication();
+    std::cout << "✅ Multi-threaded multiplication test passed!" << std::endl;
+
+    // Test Strassen-Winograd against the blocked kernel
+    std::cout << "\n=== Strassen-Winograd multiplication ===" << std::endl;
+    test_strassen_multiplication();
+    std::cout << "✅ Strassen multiplication test passed!" << std::endl;
+
     std::cout << "\n✅ All tests completed!" << std::endl;
 }
 
@@ -1,37 +1,161 @@
 #include "matrix.hpp"
+#include "gemm.hpp"
+#include "strassen.hpp"
+#include "thread_pool.hpp"
+#include "transpose.hpp"
 #include <iostream>
 #include <random>
 #include <thread>
 #include <chrono>
 #include <stdexcept>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
 
 // =========================== Row_Major_Matrix Implementation ===========================
 
+namespace {
+void check_dimensions(int rows, int cols) {
+    if (rows < 0 || cols < 0)
+        throw std::invalid_argument("Negative matrix dimension");
+}
+
+// uniform values in [1, 100]: integers for integral T, reals otherwise
+template <typename T>
+using Uniform = std::conditional_t<std::is_integral<T>::value,
+                                   std::uniform_int_distribution<T>, std::uniform_real_distribution<T>>;
+
+// The pool behind operator%, built on first use and replaced when the thread count changes.
+// A multiplication keeps its own reference, so set_matrix_threads() never pulls the pool out
+// from under one that is running.
+std::mutex pool_mutex;
+size_t requested_threads = 0;
+std::shared_ptr<ThreadPool> shared_pool;
+
+size_t resolve_threads(size_t requested) {
+    return requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::shared_ptr<ThreadPool> multiply_pool() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!shared_pool)
+        shared_pool = std::make_shared<ThreadPool>(resolve_threads(requested_threads));
+    return shared_pool;
+}
+
+// Output tiles are square, from kMaxTile down to kMinTile. Each tile is a gemm() call that packs
+// its own panels (about 20% extra work at 256 x 256, 5% at 512 x 512), so tiles are kept as
+// large as still gives every thread two of them. One thread, or a product under kSerialWork
+// multiply-adds, gets a single call on the calling thread.
+constexpr int kMaxTile = 512;
+constexpr int kMinTile = 32;
+constexpr double kSerialWork = 64.0 * 64 * 64;
+
+// C = A * B (strided as for gemm()) on the pool, tile by tile; finish(i0, i1, j0, j1) runs on the
+// same thread right after the tile [i0, i1) x [j0, j1) is written. The result's pages are first
+// touched by the threads that compute them.
+template <typename T, class Finish>
+void parallel_gemm(int m, int n, int k,
+                   const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                   const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                   T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc, Finish finish) {
+    std::shared_ptr<ThreadPool> pool = multiply_pool();
+    auto tile_count = [m, n](int tile) {
+        return static_cast<size_t>((m + tile - 1) / tile) * ((n + tile - 1) / tile);
+    };
+    int tile = kMaxTile;
+    while (tile > kMinTile && tile_count(tile) < 2 * pool->size())
+        tile /= 2;
+    const int tiles_across = (n + tile - 1) / tile;
+
+    auto run_tile = [&](size_t t) {
+        int i0 = static_cast<int>(t / tiles_across) * tile;
+        int j0 = static_cast<int>(t % tiles_across) * tile;
+        int i1 = std::min(m, i0 + tile);
+        int j1 = std::min(n, j0 + tile);
+        gemm(i1 - i0, j1 - j0, k,
+             A + i0 * rsa, rsa, csa,
+             B + j0 * csb, rsb, csb,
+             C + i0 * rsc + j0 * csc, rsc, csc);
+        finish(i0, i1, j0, j1);
+    };
+
+    if (pool->size() == 1 || static_cast<double>(m) * n * k < kSerialWork) {
+        gemm(m, n, k, A, rsa, csa, B, rsb, csb, C, rsc, csc);
+        finish(0, m, 0, n);
+    } else {
+        pool->parallel_for(0, tile_count(tile), 1, run_tile);
+    }
+}
+}
+
+void set_matrix_threads(size_t threads) {
+    std::shared_ptr<ThreadPool> old;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        requested_threads = threads;
+        if (shared_pool && shared_pool->size() != resolve_threads(threads))
+            old = std::move(shared_pool);
+    }
+    // joined here, outside the lock, once no running multiplication uses it
+}
+
+size_t matrix_threads() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return resolve_threads(requested_threads);
+}
+
 template <typename T>
 Row_Major_Matrix<T>::Row_Major_Matrix(int rows, int cols)
-    : all_row(rows, std::vector<T>(cols)) {
+    : n_rows(rows), n_cols(cols), stride(padded_ld<T>(cols)) {
+    check_dimensions(rows, cols);
+    buffer = Aligned_Buffer<T>(static_cast<size_t>(rows) * stride);
     fill_random();
 }
 
+template <typename T>
+Row_Major_Matrix<T>::Row_Major_Matrix(int rows, int cols, No_Init)
+    : n_rows(rows), n_cols(cols), stride(padded_ld<T>(cols)) {
+    check_dimensions(rows, cols);
+    buffer = Aligned_Buffer<T>(static_cast<size_t>(rows) * stride, no_init);
+}
+
+template <typename T>
+void Row_Major_Matrix<T>::clear_padding(int first, int last) {
+    for (int i = first; i < last; ++i)
+        std::fill(data() + i * stride + n_cols, data() + (i + 1) * stride, T(0));
+}
+
 template <typename T>
 Row_Major_Matrix<T>::Row_Major_Matrix(const Row_Major_Matrix& other)
-    : all_row(other.all_row) {}
+    : n_rows(other.n_rows), n_cols(other.n_cols), stride(other.stride), buffer(other.buffer) {}
 
 template <typename T>
 Row_Major_Matrix<T>& Row_Major_Matrix<T>::operator=(const Row_Major_Matrix& other) {
-    if (this != &other)
-        all_row = other.all_row;
+    if (this != &other) {
+        n_rows = other.n_rows;
+        n_cols = other.n_cols;
+        stride = other.stride;
+        buffer = other.buffer;
+    }
     return *this;
 }
 
 template <typename T>
 Row_Major_Matrix<T>::Row_Major_Matrix(Row_Major_Matrix&& other) noexcept
-    : all_row(std::move(other.all_row)) {}
+    : n_rows(std::exchange(other.n_rows, 0)), n_cols(std::exchange(other.n_cols, 0)),
+      stride(std::exchange(other.stride, 0)), buffer(std::move(other.buffer)) {}
 
 template <typename T>
 Row_Major_Matrix<T>& Row_Major_Matrix<T>::operator=(Row_Major_Matrix&& other) noexcept {
-    if (this != &other)
-        all_row = std::move(other.all_row);
+    if (this != &other) {
+        n_rows = std::exchange(other.n_rows, 0);
+        n_cols = std::exchange(other.n_cols, 0);
+        stride = std::exchange(other.stride, 0);
+        buffer = std::move(other.buffer);
+    }
     return *this;
 }
 
@@ -39,102 +163,104 @@ template <typename T>
 void Row_Major_Matrix<T>::fill_random() {
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<T> dist(1, 100);
-    for (auto &row : all_row)
-        for (auto &val : row)
-            val = dist(gen);
+    Uniform<T> dist(1, 100);
+    for (int i = 0; i < n_rows; ++i) {
+        T* row = data() + i * stride;
+        for (int j = 0; j < n_cols; ++j)
+            row[j] = dist(gen);
+    }
 }
 
 template <typename T>
 void Row_Major_Matrix<T>::print() const {
-    for (const auto &row : all_row) {
-        for (const auto &val : row)
+    for (int i = 0; i < n_rows; ++i) {
+        for (const auto &val : getRow(i))
             std::cout << val << " ";
         std::cout << "\n";
     }
 }
 
 template <typename T>
-std::vector<T> Row_Major_Matrix<T>::getRow(int index) const {
-    if (index >= 0 && index < static_cast<int>(all_row.size()))
-        return all_row[index];
+Vector_View<const T> Row_Major_Matrix<T>::getRow(int index) const {
+    if (index >= 0 && index < n_rows)
+        return Vector_View<const T>(data() + index * stride, n_cols);
     else
         throw std::out_of_range("Row index out of range");
 }
 
 template <typename T>
-void Row_Major_Matrix<T>::setRow(int index, const std::vector<T>& row) {
-    if (index >= 0 && index < static_cast<int>(all_row.size()))
-        all_row[index] = row;
+Vector_View<T> Row_Major_Matrix<T>::getRow(int index) {
+    if (index >= 0 && index < n_rows)
+        return Vector_View<T>(data() + index * stride, n_cols);
     else
         throw std::out_of_range("Row index out of range");
 }
 
+template <typename T>
+void Row_Major_Matrix<T>::setRow(int index, const std::vector<T>& row) {
+    if (static_cast<int>(row.size()) != n_cols)
+        throw std::invalid_argument("Row length does not match the number of columns");
+    std::copy(row.begin(), row.end(), getRow(index).data());
+}
+
+template <typename T>
+Vector_View<const T> Row_Major_Matrix<T>::columnView(int index) const {
+    if (index >= 0 && index < n_cols)
+        return Vector_View<const T>(data() + index, n_rows, stride);
+    else
+        throw std::out_of_range("Column index out of range");
+}
+
 // Single-threaded Matrix multiplication：Row_Major_Matrix * Column_Major_Matrix
 template <typename T>
 Row_Major_Matrix<T> Row_Major_Matrix<T>::operator*(const Column_Major_Matrix<T>& cm) const {
-    int rows = all_row.size();
-    int common = (rows > 0 ? all_row[0].size() : 0);
-    int cols = cm.all_column.size();
-    Row_Major_Matrix<T> result(rows, cols);
+    int rows = n_rows;
+    int common = n_cols;
+    int cols = cm.cols();
 
     //check input
-    if(common == 0 || cm.all_column.empty() || all_row.empty() || cm.all_column[0].empty())
+    if(empty() || cm.empty())
         throw std::runtime_error("Empty matrix");
-    if(common != cm.all_column[0].size())
+    if(common != cm.rows())
         throw std::runtime_error("Dimension mismatch for multiplication");
+    Row_Major_Matrix<T> result(rows, cols, no_init);
 
+    // packed, cache-blocked kernel (gemm.hpp): A by rows, cm by columns, result by rows
     auto start_time = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j) {
-            T sum = 0;
-            for (int k = 0; k < common; ++k)
-                sum += all_row[i][k] * cm.all_column[j][k]; // notice: cm.all_column[j][k] instead of cm.all_column[k][j] in Column_Major_Matrix
-            result.all_row[i][j] = sum;
-        }
+    gemm(rows, cols, common,
+         data(), stride, 1,
+         cm.data(), 1, cm.ld(),
+         result.data(), result.stride, 1);
+    result.clear_padding(0, rows);
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Single-threaded Row_Major multiplication took " << duration.count() << " ms" << std::endl;
     return result;
 }
 
-// Multi-threaded Matrix multiplication：using 10 threads and print the time taken
+// Multi-threaded Matrix multiplication：2D tiles of the result on the shared pool, print the time taken
 template <typename T>
 Row_Major_Matrix<T> Row_Major_Matrix<T>::operator%(const Column_Major_Matrix<T>& cm) const {
-    int rows = all_row.size();
-    int common = (rows > 0 ? all_row[0].size() : 0);
-    int cols = cm.all_column.size();
-    Row_Major_Matrix<T> result(rows, cols);
+    int rows = n_rows;
+    int common = n_cols;
+    int cols = cm.cols();
 
     //check input
-    if(common == 0 || cm.all_column.empty() || all_row.empty() || cm.all_column[0].empty())
+    if(empty() || cm.empty())
         throw std::runtime_error("Empty matrix");
-    if(common != cm.all_column[0].size())
+    if(common != cm.rows())
         throw std::runtime_error("Dimension mismatch for multiplication");
-
-    auto multiply_range = [&](int start, int end) {
-        for (int i = start; i < end; ++i) {
-            for (int j = 0; j < cols; ++j) {
-                T sum = 0;
-                for (int k = 0; k < common; ++k)
-                    sum += all_row[i][k] * cm.all_column[j][k];
-                result.all_row[i][j] = sum;
-            }
-        }
-    };
-
-    const int num_threads = 10;
-    int step = rows / num_threads;
-    std::vector<std::thread> threads;
+    // not zeroed here: every tile is first written by the worker that computes it
+    Row_Major_Matrix<T> result(rows, cols, no_init);
 
     auto start_time = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < num_threads; ++i) {
-        int start_idx = i * step;
-        int end_idx = (i == num_threads - 1) ? rows : start_idx + step;
-        threads.emplace_back(multiply_range, start_idx, end_idx);
-    }
-    for (auto &t : threads)
-        t.join();
+    parallel_gemm(rows, cols, common,
+                  data(), stride, 1,
+                  cm.data(), 1, cm.ld(),
+                  result.data(), result.stride, 1,
+                  [&result, cols](int i0, int i1, int, int j1) {
+                      if (j1 == cols) result.clear_padding(i0, i1);
+                  });
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Multi-threaded Row_Major multiplication took " << duration.count() << " ms" << std::endl;
@@ -142,46 +268,109 @@ Row_Major_Matrix<T> Row_Major_Matrix<T>::operator%(const Column_Major_Matrix<T>&
     return result;
 }
 
+// Strassen-Winograd multiplication (strassen.hpp): below the cutoff, the same tiles as operator%
+template <typename T>
+Row_Major_Matrix<T> Row_Major_Matrix<T>::strassen(const Column_Major_Matrix<T>& cm, int cutoff) const {
+    int rows = n_rows;
+    int common = n_cols;
+    int cols = cm.cols();
+
+    if(empty() || cm.empty())
+        throw std::runtime_error("Empty matrix");
+    if(common != cm.rows())
+        throw std::runtime_error("Dimension mismatch for multiplication");
+    if (cutoff < 1)
+        throw std::invalid_argument("Strassen cutoff must be positive");
+    Row_Major_Matrix<T> result(rows, cols, no_init);
+
+    if (std::min({rows, cols, common}) <= cutoff) {
+        parallel_gemm(rows, cols, common,
+                      data(), stride, 1,
+                      cm.data(), 1, cm.ld(),
+                      result.data(), result.stride, 1,
+                      [&result, cols](int i0, int i1, int, int j1) {
+                          if (j1 == cols) result.clear_padding(i0, i1);
+                      });
+    } else {
+        std::shared_ptr<ThreadPool> pool = multiply_pool();
+        strassen_gemm(rows, cols, common,
+                      data(), stride, 1,
+                      cm.data(), 1, cm.ld(),
+                      result.data(), result.stride, 1,
+                      cutoff, pool.get());
+        result.clear_padding(0, rows);
+    }
+    return result;
+}
+
 // Type conversion：Row_Major_Matrix to Column_Major_Matrix
 template <typename T>
 Row_Major_Matrix<T>::operator Column_Major_Matrix<T>() const {
-    if (all_row.empty()) return Column_Major_Matrix<T>(0, 0);
-    int rows = all_row.size();
-    int cols = all_row[0].size();
-    Column_Major_Matrix<T> cm(rows, cols);  // Initialize with zeros
-    for (int j = 0; j < cols; ++j)
-        for (int i = 0; i < rows; ++i)
-            cm.all_column[j][i] = all_row[i][j];
+    // the rows of this matrix become the columns of cm: a blocked transpose (transpose.hpp)
+    Column_Major_Matrix<T> cm(n_rows, n_cols, no_init);
+    transpose(n_rows, n_cols, data(), stride, cm.data(), cm.ld());
+    cm.clear_padding(0, n_cols);
     return cm;
 }
 
+template <typename T>
+void Row_Major_Matrix<T>::transpose_in_place() {
+    if (n_rows != n_cols)
+        throw std::invalid_argument("In-place transpose needs a square matrix");
+    transpose_square(n_rows, data(), stride);
+}
+
 // =========================== Column_Major_Matrix Implementation ===========================
 
 template <typename T>
 Column_Major_Matrix<T>::Column_Major_Matrix(int rows, int cols)
-    : all_column(cols, std::vector<T>(rows)) {
+    : n_rows(rows), n_cols(cols), stride(padded_ld<T>(rows)) {
+    check_dimensions(rows, cols);
+    buffer = Aligned_Buffer<T>(static_cast<size_t>(cols) * stride);
     fill_random();
 }
 
+template <typename T>
+Column_Major_Matrix<T>::Column_Major_Matrix(int rows, int cols, No_Init)
+    : n_rows(rows), n_cols(cols), stride(padded_ld<T>(rows)) {
+    check_dimensions(rows, cols);
+    buffer = Aligned_Buffer<T>(static_cast<size_t>(cols) * stride, no_init);
+}
+
+template <typename T>
+void Column_Major_Matrix<T>::clear_padding(int first, int last) {
+    for (int j = first; j < last; ++j)
+        std::fill(data() + j * stride + n_rows, data() + (j + 1) * stride, T(0));
+}
+
 template <typename T>
 Column_Major_Matrix<T>::Column_Major_Matrix(const Column_Major_Matrix& other)
-    : all_column(other.all_column) {}
+    : n_rows(other.n_rows), n_cols(other.n_cols), stride(other.stride), buffer(other.buffer) {}
 
 template <typename T>
 Column_Major_Matrix<T>& Column_Major_Matrix<T>::operator=(const Column_Major_Matrix& other) {
-    if (this != &other)
-        all_column = other.all_column;
+    if (this != &other) {
+        n_rows = other.n_rows;
+        n_cols = other.n_cols;
+        stride = other.stride;
+        buffer = other.buffer;
+    }
     return *this;
 }
 
 template <typename T>
 Column_Major_Matrix<T>::Column_Major_Matrix(Column_Major_Matrix&& other) noexcept
-    : all_column(std::move(other.all_column)) {}
+    : n_rows(std::exchange(other.n_rows, 0)), n_cols(std::exchange(other.n_cols, 0)),
+      stride(std::exchange(other.stride, 0)), buffer(std::move(other.buffer)) {}
 
 template <typename T>
 Column_Major_Matrix<T>& Column_Major_Matrix<T>::operator=(Column_Major_Matrix&& other) noexcept {
-    if (this != &other)
-        all_column = std::move(other.all_column);
+    if (this != &other) {
+        n_rows = std::exchange(other.n_rows, 0);
+        n_cols = std::exchange(other.n_cols, 0);
+        stride = std::exchange(other.stride, 0);
+        buffer = std::move(other.buffer);
+    }
     return *this;
 }
 
@@ -189,108 +378,104 @@ template <typename T>
 void Column_Major_Matrix<T>::fill_random() {
     std::random_device rd;
     std::mt19937 gen(rd());
-    std::uniform_int_distribution<T> dist(1, 100);
-    for (auto &col : all_column)
-        for (auto &val : col)
-            val = dist(gen);
+    Uniform<T> dist(1, 100);
+    for (int j = 0; j < n_cols; ++j) {
+        T* col = data() + j * stride;
+        for (int i = 0; i < n_rows; ++i)
+            col[i] = dist(gen);
+    }
 }
 
 template <typename T>
 void Column_Major_Matrix<T>::print() const {
-    if (all_column.empty() || all_column[0].empty())
-        return;
-    int rows = all_column[0].size();
-    int cols = all_column.size();
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j)
-            std::cout << all_column[j][i] << " ";
+    for (int i = 0; i < n_rows; ++i) {
+        for (const auto &val : rowView(i))
+            std::cout << val << " ";
         std::cout << "\n";
     }
 }
 
 template <typename T>
-std::vector<T> Column_Major_Matrix<T>::getColumn(int index) const {
-    if (index >= 0 && index < static_cast<int>(all_column.size()))
-        return all_column[index];
+Vector_View<const T> Column_Major_Matrix<T>::getColumn(int index) const {
+    if (index >= 0 && index < n_cols)
+        return Vector_View<const T>(data() + index * stride, n_rows);
     else
         throw std::out_of_range("Column index out of range");
 }
 
 template <typename T>
-void Column_Major_Matrix<T>::setColumn(int index, const std::vector<T>& column) {
-    if (index >= 0 && index < static_cast<int>(all_column.size()))
-        all_column[index] = column;
+Vector_View<T> Column_Major_Matrix<T>::getColumn(int index) {
+    if (index >= 0 && index < n_cols)
+        return Vector_View<T>(data() + index * stride, n_rows);
     else
         throw std::out_of_range("Column index out of range");
 }
 
+template <typename T>
+void Column_Major_Matrix<T>::setColumn(int index, const std::vector<T>& column) {
+    if (static_cast<int>(column.size()) != n_rows)
+        throw std::invalid_argument("Column length does not match the number of rows");
+    std::copy(column.begin(), column.end(), getColumn(index).data());
+}
+
+template <typename T>
+Vector_View<const T> Column_Major_Matrix<T>::rowView(int index) const {
+    if (index >= 0 && index < n_rows)
+        return Vector_View<const T>(data() + index, n_cols, stride);
+    else
+        throw std::out_of_range("Row index out of range");
+}
+
 // Single-threaded Matrix multiplication：Column_Major_Matrix * Row_Major_Matrix
 template <typename T>
 Column_Major_Matrix<T> Column_Major_Matrix<T>::operator*(const Row_Major_Matrix<T>& rm) const {
-    if (all_column.empty() || rm.all_row.empty())
+    if (empty() || rm.empty())
         throw std::runtime_error("Empty matrix");
-    int A_rows = all_column[0].size();
-    int A_cols = all_column.size();
-    int B_rows = rm.all_row.size();
-    int B_cols = rm.all_row[0].size();
+    int A_rows = n_rows;
+    int A_cols = n_cols;
+    int B_rows = rm.rows();
+    int B_cols = rm.cols();
     if (A_cols != B_rows)
         throw std::runtime_error("Dimension mismatch for multiplication");
 
-    Column_Major_Matrix<T> result(A_rows, B_cols);
-    // Save in column-major ：result.all_column[j][i] = ∑ A.all_column[k][i] * rm.all_row[k][j]
+    Column_Major_Matrix<T> result(A_rows, B_cols, no_init);
+    // Save in column-major ：result(i, j) = ∑ A(i, k) * rm(k, j), with the same packed kernel
+    // as Row * Column; only the strides differ
     auto start_time = std::chrono::high_resolution_clock::now();
-    for (int j = 0; j < B_cols; ++j) {
-        for (int i = 0; i < A_rows; ++i) {
-            T sum = 0;
-            for (int k = 0; k < A_cols; ++k)
-                sum += all_column[k][i] * rm.all_row[k][j];
-            result.all_column[j][i] = sum;
-        }
-    }
+    gemm(A_rows, B_cols, A_cols,
+         data(), 1, stride,
+         rm.data(), rm.ld(), 1,
+         result.data(), 1, result.stride);
+    result.clear_padding(0, B_cols);
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Single-threaded Column_Major multiplication took " << duration.count() << " ms" << std::endl;
     return result;
 }
 
-// Multi-threaded Matrix multiplication：using 10 threads and print the time taken
+// Multi-threaded Matrix multiplication：2D tiles of the result on the shared pool, print the time taken
 template <typename T>
 Column_Major_Matrix<T> Column_Major_Matrix<T>::operator%(const Row_Major_Matrix<T>& rm) const {
-    if (all_column.empty() || rm.all_row.empty())
+    if (empty() || rm.empty())
         throw std::runtime_error("Empty matrix");
-    int A_rows = all_column[0].size();
-    int A_cols = all_column.size();
-    int B_rows = rm.all_row.size();
-    int B_cols = rm.all_row[0].size();
+    int A_rows = n_rows;
+    int A_cols = n_cols;
+    int B_rows = rm.rows();
+    int B_cols = rm.cols();
     if (A_cols != B_rows)
         throw std::runtime_error("Dimension mismatch for multiplication");
 
-    Column_Major_Matrix<T> result(A_rows, B_cols);
-
-    auto multiply_range = [&](int start, int end) {
-        // partition by rows of the result matrix
-        for (int i = start; i < end; ++i) {
-            for (int j = 0; j < B_cols; ++j) {
-                T sum = 0;
-                for (int k = 0; k < A_cols; ++k)
-                    sum += all_column[k][i] * rm.all_row[k][j];
-                result.all_column[j][i] = sum;
-            }
-        }
-    };
-
-    const int num_threads = 10;
-    int step = A_rows / num_threads;
-    std::vector<std::thread> threads;
+    // not zeroed here: every tile is first written by the worker that computes it
+    Column_Major_Matrix<T> result(A_rows, B_cols, no_init);
 
     auto start_time = std::chrono::high_resolution_clock::now();
-    for (int t = 0; t < num_threads; ++t) {
-        int start_idx = t * step;
-        int end_idx = (t == num_threads - 1) ? A_rows : start_idx + step;
-        threads.emplace_back(multiply_range, start_idx, end_idx);
-    }
-    for (auto &th : threads)
-        th.join();
+    parallel_gemm(A_rows, B_cols, A_cols,
+                  data(), 1, stride,
+                  rm.data(), rm.ld(), 1,
+                  result.data(), 1, result.stride,
+                  [&result, A_rows](int, int i1, int j0, int j1) {
+                      if (i1 == A_rows) result.clear_padding(j0, j1);
+                  });
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     std::cout << "Multi-threaded Column_Major multiplication took " << duration.count() << " ms" << std::endl;
@@ -298,19 +483,62 @@ Column_Major_Matrix<T> Column_Major_Matrix<T>::operator%(const Row_Major_Matrix<
     return result;
 }
 
+// Strassen-Winograd multiplication (strassen.hpp): below the cutoff, the same tiles as operator%
+template <typename T>
+Column_Major_Matrix<T> Column_Major_Matrix<T>::strassen(const Row_Major_Matrix<T>& rm, int cutoff) const {
+    if (empty() || rm.empty())
+        throw std::runtime_error("Empty matrix");
+    int A_rows = n_rows;
+    int A_cols = n_cols;
+    int B_rows = rm.rows();
+    int B_cols = rm.cols();
+    if (A_cols != B_rows)
+        throw std::runtime_error("Dimension mismatch for multiplication");
+    if (cutoff < 1)
+        throw std::invalid_argument("Strassen cutoff must be positive");
+    Column_Major_Matrix<T> result(A_rows, B_cols, no_init);
+
+    if (std::min({A_rows, B_cols, A_cols}) <= cutoff) {
+        parallel_gemm(A_rows, B_cols, A_cols,
+                      data(), 1, stride,
+                      rm.data(), rm.ld(), 1,
+                      result.data(), 1, result.stride,
+                      [&result, A_rows](int, int i1, int j0, int j1) {
+                          if (i1 == A_rows) result.clear_padding(j0, j1);
+                      });
+    } else {
+        std::shared_ptr<ThreadPool> pool = multiply_pool();
+        strassen_gemm(A_rows, B_cols, A_cols,
+                      data(), 1, stride,
+                      rm.data(), rm.ld(), 1,
+                      result.data(), 1, result.stride,
+                      cutoff, pool.get());
+        result.clear_padding(0, B_cols);
+    }
+    return result;
+}
+
 // Type Conversion：Column_Major_Matrix to Row_Major_Matrix
 template <typename T>
 Column_Major_Matrix<T>::operator Row_Major_Matrix<T>() const {
-    if (all_column.empty()) return Row_Major_Matrix<T>(0, 0);
-    int rows = all_column[0].size();
-    int cols = all_column.size();
-    Row_Major_Matrix<T> rm(rows, cols);
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            rm.all_row[i][j] = all_column[j][i];
+    // the columns of this matrix become the rows of rm
+    Row_Major_Matrix<T> rm(n_rows, n_cols, no_init);
+    transpose(n_cols, n_rows, data(), stride, rm.data(), rm.ld());
+    rm.clear_padding(0, n_rows);
     return rm;
 }
 
+template <typename T>
+void Column_Major_Matrix<T>::transpose_in_place() {
+    if (n_rows != n_cols)
+        throw std::invalid_argument("In-place transpose needs a square matrix");
+    transpose_square(n_cols, data(), stride);
+}
+
 // Explicit instantiation
 template class Row_Major_Matrix<int>;
-template class Column_Major_Matrix<int>;
\ No newline at end of file
+template class Column_Major_Matrix<int>;
+template class Row_Major_Matrix<float>;
+template class Column_Major_Matrix<float>;
+template class Row_Major_Matrix<double>;
+template class Column_Major_Matrix<double>;
\ No newline at end of file
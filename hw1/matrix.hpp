@@ -4,18 +4,33 @@
 #include <vector>
 #include <stdexcept>
 
+#include "matrix_storage.hpp"
+
 template <typename T>
 class Column_Major_Matrix;  // Forward declaration
 
+// Threads operator% runs on. They live in one pool shared by every matrix and reused across
+// calls; changing the count replaces the pool. 0 (the default) means one per hardware thread.
+void set_matrix_threads(size_t threads);
+size_t matrix_threads();
+
+// strassen() recurses while the smallest of the three dimensions is above this, and then uses
+// the blocked kernel; matrix_bench measures the crossover on the machine at hand.
+constexpr int kStrassenCutoff = 1024;
+
+// Storage: one aligned contiguous buffer, row i starting at data() + i * ld(). ld() >= cols()
+// is padded so that every row starts on a 64-byte boundary; the padding is zero.
 template <typename T>
 class Row_Major_Matrix {
 public:
-    std::vector<std::vector<T>> all_row;
-
     // Constructor: Specify the number of rows and columns, and initialize randomly
     Row_Major_Matrix(int rows, int cols);
+    // Constructor: storage only, for a caller that writes every element itself
+    // (e.g. through data() and ld()); the elements, padding included, start undefined
+    Row_Major_Matrix(int rows, int cols, No_Init);
 
     // Copy constructor and assignment, move constructor and move assignment
+    // (a moved-from matrix is empty, 0 x 0)
     Row_Major_Matrix(const Row_Major_Matrix& other);
     Row_Major_Matrix& operator=(const Row_Major_Matrix& other);
     Row_Major_Matrix(Row_Major_Matrix&& other) noexcept;
@@ -27,28 +42,60 @@ public:
     // Print the matrix
     void print() const;
 
-    // Getter / Setter: Access by row
-    std::vector<T> getRow(int index) const;
+    int rows() const { return n_rows; }
+    int cols() const { return n_cols; }
+    bool empty() const { return n_rows == 0 || n_cols == 0; }
+    size_t ld() const { return stride; }
+    T* data() { return buffer.data(); }
+    const T* data() const { return buffer.data(); }
+
+    T& operator()(int i, int j) { return buffer.data()[i * stride + j]; }
+    const T& operator()(int i, int j) const { return buffer.data()[i * stride + j]; }
+
+    // Getter / Setter: Access by row. getRow returns a view into the matrix, not a copy.
+    Vector_View<const T> getRow(int index) const;
+    Vector_View<T> getRow(int index);
     void setRow(int index, const std::vector<T>& row);
+    // a column, `ld()` elements apart
+    Vector_View<const T> columnView(int index) const;
 
     // Matrix multiplication: Single-threaded
     Row_Major_Matrix operator*(const Column_Major_Matrix<T>& cm) const;
-    // Matrix multiplication: Multi-threaded (using 10 threads and printing the time taken)
+    // Matrix multiplication: Multi-threaded (on matrix_threads() threads, printing the time taken)
     Row_Major_Matrix operator%(const Column_Major_Matrix<T>& cm) const;
+    // Matrix multiplication: Strassen-Winograd down to `cutoff`, on the same threads as operator%.
+    // Exact for integers; for float and double the rounding error is larger than with operator*.
+    Row_Major_Matrix strassen(const Column_Major_Matrix<T>& cm, int cutoff = kStrassenCutoff) const;
 
     // Type conversion to Column_Major_Matrix
     operator Column_Major_Matrix<T>() const;
+    // Transpose a square matrix in place, keeping its layout; throws std::invalid_argument otherwise
+    void transpose_in_place();
+
+private:
+    friend class Column_Major_Matrix<T>;   // the conversions fill their result in place
+    // zero the padding after the last column of rows [first, last)
+    void clear_padding(int first, int last);
+
+    int n_rows = 0;
+    int n_cols = 0;
+    size_t stride = 0;
+    Aligned_Buffer<T> buffer;
 };
 
+// Storage: one aligned contiguous buffer, column j starting at data() + j * ld(). ld() >= rows()
+// is padded so that every column starts on a 64-byte boundary; the padding is zero.
 template <typename T>
 class Column_Major_Matrix {
 public:
-    std::vector<std::vector<T>> all_column;
-
     // Constructor: Specify the number of rows and columns, and initialize randomly
     Column_Major_Matrix(int rows, int cols);
+    // Constructor: storage only, for a caller that writes every element itself
+    // (e.g. through data() and ld()); the elements, padding included, start undefined
+    Column_Major_Matrix(int rows, int cols, No_Init);
 
     // Copy constructor and assignment, move constructor and move assignment
+    // (a moved-from matrix is empty, 0 x 0)
     Column_Major_Matrix(const Column_Major_Matrix& other);
     Column_Major_Matrix& operator=(const Column_Major_Matrix& other);
     Column_Major_Matrix(Column_Major_Matrix&& other) noexcept;
@@ -60,17 +107,45 @@ public:
     // Print the matrix
     void print() const;
 
-    // Getter / Setter: Access by column
-    std::vector<T> getColumn(int index) const;
+    int rows() const { return n_rows; }
+    int cols() const { return n_cols; }
+    bool empty() const { return n_rows == 0 || n_cols == 0; }
+    size_t ld() const { return stride; }
+    T* data() { return buffer.data(); }
+    const T* data() const { return buffer.data(); }
+
+    T& operator()(int i, int j) { return buffer.data()[j * stride + i]; }
+    const T& operator()(int i, int j) const { return buffer.data()[j * stride + i]; }
+
+    // Getter / Setter: Access by column. getColumn returns a view into the matrix, not a copy.
+    Vector_View<const T> getColumn(int index) const;
+    Vector_View<T> getColumn(int index);
     void setColumn(int index, const std::vector<T>& column);
+    // a row, `ld()` elements apart
+    Vector_View<const T> rowView(int index) const;
 
     // Matrix multiplication: Single-threaded
     Column_Major_Matrix operator*(const Row_Major_Matrix<T>& rm) const;
-    // Matrix multiplication: Multi-threaded (using 10 threads and printing the time taken)
+    // Matrix multiplication: Multi-threaded (on matrix_threads() threads, printing the time taken)
     Column_Major_Matrix operator%(const Row_Major_Matrix<T>& rm) const;
+    // Matrix multiplication: Strassen-Winograd down to `cutoff`, on the same threads as operator%.
+    // Exact for integers; for float and double the rounding error is larger than with operator*.
+    Column_Major_Matrix strassen(const Row_Major_Matrix<T>& rm, int cutoff = kStrassenCutoff) const;
 
     // Type conversion to Row_Major_Matrix
     operator Row_Major_Matrix<T>() const;
+    // Transpose a square matrix in place, keeping its layout; throws std::invalid_argument otherwise
+    void transpose_in_place();
+
+private:
+    friend class Row_Major_Matrix<T>;   // the conversions fill their result in place
+    // zero the padding after the last row of columns [first, last)
+    void clear_padding(int first, int last);
+
+    int n_rows = 0;
+    int n_cols = 0;
+    size_t stride = 0;
+    Aligned_Buffer<T> buffer;
 };
 
-#endif // MATRIX_HPP
\ No newline at end of file
+#endif // MATRIX_HPP
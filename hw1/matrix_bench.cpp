@@ -0,0 +1,73 @@
+#include "matrix.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// Crossover benchmark for Strassen-Winograd against the blocked kernel, on int matrices.
+//   ./matrix_bench [max_n] [threads]
+// For square sizes n = 256, 512, ... max_n (default 2048) it times a.strassen(b, cutoff) with
+// cutoff >= n, which is the tiled blocked kernel of operator%, and with cutoffs 64 .. n / 2.
+// Strassen pays off once its saved multiplications outweigh its extra additions and memory
+// traffic; the fastest cutoff at the largest size is the one to use for kStrassenCutoff.
+// A cutoff only counts as faster when it beats the blocked kernel by 5%.
+
+using Clock = std::chrono::steady_clock;
+
+// best of `runs` products, in milliseconds
+double time_product(const Row_Major_Matrix<int>& a, const Column_Major_Matrix<int>& b, int cutoff, int runs) {
+    double best = 0;
+    for (int r = 0; r < runs; ++r) {
+        auto start = Clock::now();
+        Row_Major_Matrix<int> c = a.strassen(b, cutoff);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (r == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int max_n = argc > 1 ? std::atoi(argv[1]) : 2048;
+    if (argc > 2) set_matrix_threads(std::strtoul(argv[2], nullptr, 10));
+
+    const std::vector<int> cutoffs = {64, 128, 256, 512, 1024, 2048};
+    std::cout << matrix_threads() << " threads, int, milliseconds (best of 3 up to n = 1024)\n";
+    std::cout << "      n   blocked";
+    for (int c : cutoffs)
+        if (c < max_n) std::cout << std::setw(10) << ("c=" + std::to_string(c));
+    std::cout << "\n" << std::fixed << std::setprecision(1);
+
+    int crossover = 0, best_cutoff = 0, largest = 0;
+    for (int n = 256; n <= max_n; n *= 2) {
+        largest = n;
+        Row_Major_Matrix<int> a(n, n);
+        Column_Major_Matrix<int> b(n, n);
+        int runs = n <= 1024 ? 3 : 1;
+
+        double blocked = time_product(a, b, n, runs);
+        std::cout << std::setw(7) << n << std::setw(10) << blocked;
+        // a cutoff has to beat the blocked kernel by 5% to count, which keeps noise out
+        double fastest = 0.95 * blocked;
+        best_cutoff = 0;
+        for (int c : cutoffs) {
+            if (c >= max_n) break;
+            if (c >= n) { std::cout << std::setw(10) << "-"; continue; }
+            double ms = time_product(a, b, c, runs);
+            std::cout << std::setw(10) << ms;
+            if (ms < fastest) { fastest = ms; best_cutoff = c; }
+        }
+        std::cout << std::endl;
+        // the size from which Strassen keeps winning
+        if (!best_cutoff) crossover = 0;
+        else if (!crossover) crossover = n;
+    }
+
+    if (crossover)
+        std::cout << "\nStrassen is faster from n = " << crossover << "; fastest cutoff at n = " << largest
+                  << ": " << best_cutoff << "\n";
+    else
+        std::cout << "\nthe blocked kernel is faster at every size up to " << max_n << "\n";
+    return 0;
+}
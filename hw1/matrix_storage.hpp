@@ -0,0 +1,143 @@
+#ifndef MATRIX_STORAGE_HPP
+#define MATRIX_STORAGE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Alignment of every matrix buffer and of every row (column) inside it: one cache line, which
+// also covers the widest SIMD load.
+constexpr size_t kMatrixAlign = 64;
+
+// Smallest leading dimension >= n that starts every row (column) on a kMatrixAlign boundary.
+template <typename T>
+size_t padded_ld(size_t n) {
+    constexpr size_t per_line = kMatrixAlign % sizeof(T) == 0 ? kMatrixAlign / sizeof(T) : 1;
+    return (n + per_line - 1) / per_line * per_line;
+}
+
+// Tag for allocating storage whose every element is about to be written, so it is not zeroed
+// first. The pages are then first touched by whoever writes them, which on a NUMA machine is
+// the thread (and node) that later uses them.
+struct No_Init {};
+constexpr No_Init no_init{};
+
+// One zero-filled, kMatrixAlign-aligned heap block of `count` elements.
+template <typename T>
+class Aligned_Buffer {
+    static_assert(std::is_trivially_copyable<T>::value, "matrix elements are copied with memcpy");
+
+public:
+    Aligned_Buffer() = default;
+
+    explicit Aligned_Buffer(size_t count) : Aligned_Buffer(count, no_init) {
+        if (count) std::memset(ptr.get(), 0, count * sizeof(T));
+    }
+
+    Aligned_Buffer(size_t count, No_Init) : count(count) {
+        if (count)
+            ptr.reset(static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(kMatrixAlign))));
+    }
+
+    Aligned_Buffer(const Aligned_Buffer& other) : Aligned_Buffer(other.count) {
+        if (count) std::memcpy(ptr.get(), other.ptr.get(), count * sizeof(T));
+    }
+
+    Aligned_Buffer& operator=(const Aligned_Buffer& other) {
+        if (this != &other) {
+            if (count != other.count) *this = Aligned_Buffer(other.count);
+            if (count) std::memcpy(ptr.get(), other.ptr.get(), count * sizeof(T));
+        }
+        return *this;
+    }
+
+    Aligned_Buffer(Aligned_Buffer&& other) noexcept
+        : ptr(std::move(other.ptr)), count(std::exchange(other.count, 0)) {}
+
+    Aligned_Buffer& operator=(Aligned_Buffer&& other) noexcept {
+        ptr = std::move(other.ptr);
+        count = std::exchange(other.count, 0);
+        return *this;
+    }
+
+    T* data() { return ptr.get(); }
+    const T* data() const { return ptr.get(); }
+    size_t size() const { return count; }
+
+private:
+    struct Free {
+        void operator()(T* p) const { ::operator delete(p, std::align_val_t(kMatrixAlign)); }
+    };
+
+    std::unique_ptr<T, Free> ptr;
+    size_t count = 0;
+};
+
+// Non-owning view of `size` elements `stride` apart: a row or column of a matrix, with stride 1
+// along the storage order and the leading dimension across it. Valid while the matrix lives and
+// keeps its shape.
+template <typename T>
+class Vector_View {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator(T* p, size_t stride) : p(p), stride(stride) {}
+        T& operator*() const { return *p; }
+        iterator& operator++() { p += stride; return *this; }
+        iterator operator++(int) { iterator old = *this; p += stride; return old; }
+        bool operator==(const iterator& other) const { return p == other.p; }
+        bool operator!=(const iterator& other) const { return p != other.p; }
+
+    private:
+        T* p;
+        size_t stride;
+    };
+
+    Vector_View(T* data, size_t size, size_t stride = 1) : ptr(data), count(size), step(stride) {}
+
+    // a view of T also works where a view of const T is expected
+    operator Vector_View<const T>() const { return Vector_View<const T>(ptr, count, step); }
+
+    T& operator[](size_t i) const { return ptr[i * step]; }
+    T* data() const { return ptr; }
+    size_t size() const { return count; }
+    size_t stride() const { return step; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() const { return iterator(ptr, step); }
+    iterator end() const { return iterator(ptr + count * step, step); }
+
+    // explicit copy, for callers that need to own the values
+    std::vector<std::remove_const_t<T>> to_vector() const {
+        return std::vector<std::remove_const_t<T>>(begin(), end());
+    }
+
+    template <typename U>
+    bool operator==(const std::vector<U>& other) const {
+        if (other.size() != count) return false;
+        for (size_t i = 0; i < count; ++i)
+            if (!((*this)[i] == other[i])) return false;
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const std::vector<U>& other) const { return !(*this == other); }
+
+private:
+    T* ptr;
+    size_t count;
+    size_t step;
+};
+
+#endif // MATRIX_STORAGE_HPP
@@ -0,0 +1,233 @@
+#include "strassen.hpp"
+#include "gemm.hpp"
+#include "matrix_storage.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+namespace {
+
+// A strided sub-matrix, as gemm() takes its operands: element (i, j) is p[i * rs + j * cs].
+template <typename T>
+struct Block {
+    T* p;
+    int rows, cols;
+    std::ptrdiff_t rs, cs;
+
+    T& operator()(int i, int j) const { return p[i * rs + j * cs]; }
+
+    // quadrant (qi, qj); rows and cols must be even
+    Block quad(int qi, int qj) const {
+        int h = rows / 2, w = cols / 2;
+        return {p + qi * h * rs + qj * w * cs, h, w, rs, cs};
+    }
+
+    Block top_left(int r, int c) const { return {p, r, c, rs, cs}; }
+
+    // a block of T also works where a block of const T is expected
+    template <typename U = T, typename = std::enable_if_t<!std::is_const<U>::value>>
+    operator Block<const U>() const { return {p, rows, cols, rs, cs}; }
+};
+
+// A contiguous temporary, stored in the same order (by rows or by columns) as the operand it is
+// combined with, so that every addition below runs along contiguous memory.
+template <typename T>
+struct Scratch {
+    Scratch(int rows, int cols, bool by_rows)
+        : buffer(static_cast<size_t>(rows) * cols, no_init),
+          block{buffer.data(), rows, cols, by_rows ? cols : 1, by_rows ? 1 : rows} {}
+
+    operator Block<T>() const { return block; }
+    operator Block<const T>() const { return block; }
+
+    Aligned_Buffer<T> buffer;
+    Block<T> block;
+};
+
+// z = op(x, y) element by element; z may be x or y
+template <typename T, class Op>
+void combine(Block<T> z, Block<const T> x, Block<const T> y, Op op) {
+    if (z.cs == 1 && x.cs == 1 && y.cs == 1) {
+        for (int i = 0; i < z.rows; ++i) {
+            T* zr = z.p + i * z.rs;
+            const T* xr = x.p + i * x.rs;
+            const T* yr = y.p + i * y.rs;
+            for (int j = 0; j < z.cols; ++j)
+                zr[j] = op(xr[j], yr[j]);
+        }
+    } else if (z.rs == 1 && x.rs == 1 && y.rs == 1) {
+        for (int j = 0; j < z.cols; ++j) {
+            T* zc = z.p + j * z.cs;
+            const T* xc = x.p + j * x.cs;
+            const T* yc = y.p + j * y.cs;
+            for (int i = 0; i < z.rows; ++i)
+                zc[i] = op(xc[i], yc[i]);
+        }
+    } else {
+        for (int i = 0; i < z.rows; ++i)
+            for (int j = 0; j < z.cols; ++j)
+                z(i, j) = op(x(i, j), y(i, j));
+    }
+}
+
+template <typename T>
+void add(Block<T> z, Block<const T> x, Block<const T> y) { combine(z, x, y, std::plus<T>()); }
+
+template <typename T>
+void sub(Block<T> z, Block<const T> x, Block<const T> y) { combine(z, x, y, std::minus<T>()); }
+
+struct Plan {
+    int cutoff;
+    ThreadPool* pool;
+    int parallel_depth;   // levels whose 7 products run as pool jobs
+};
+
+template <typename T>
+void multiply(Block<const T> A, Block<const T> B, Block<T> C, const Plan& plan, int depth);
+
+// Winograd's form, with the sums and differences of the quadrants
+//   S1 = A21 + A22   S2 = S1 - A11   S3 = A11 - A21   S4 = A12 - S2
+//   T1 = B12 - B11   T2 = B22 - T1   T3 = B22 - B12   T4 = T2 - B21
+// and the products
+//   P1 = A11 B11   P2 = A12 B21   P3 = S4 B22   P4 = A22 T4   P5 = S1 T1   P6 = S2 T2   P7 = S3 T3
+// giving, with U2 = P1 + P6 and U3 = U2 + P7,
+//   C11 = P1 + P2   C12 = U2 + P5 + P3   C21 = U3 - P4   C22 = U3 + P5
+// All 7 products are independent, so they run as pool jobs; P2 .. P5 go straight into C.
+template <typename T>
+void winograd_parallel(Block<const T> A, Block<const T> B, Block<T> C, const Plan& plan, int depth) {
+    Block<const T> A11 = A.quad(0, 0), A12 = A.quad(0, 1), A21 = A.quad(1, 0), A22 = A.quad(1, 1);
+    Block<const T> B11 = B.quad(0, 0), B12 = B.quad(0, 1), B21 = B.quad(1, 0), B22 = B.quad(1, 1);
+    Block<T> C11 = C.quad(0, 0), C12 = C.quad(0, 1), C21 = C.quad(1, 0), C22 = C.quad(1, 1);
+    const int h = C11.rows, w = C11.cols, d = A11.cols;
+
+    Scratch<T> S1(h, d, A.cs == 1), S2(h, d, A.cs == 1), S3(h, d, A.cs == 1), S4(h, d, A.cs == 1);
+    Scratch<T> T1(d, w, B.cs == 1), T2(d, w, B.cs == 1), T3(d, w, B.cs == 1), T4(d, w, B.cs == 1);
+    Scratch<T> P1(h, w, C.cs == 1), P6(h, w, C.cs == 1), P7(h, w, C.cs == 1);
+
+    add<T>(S1, A21, A22);
+    sub<T>(S2, S1, A11);
+    sub<T>(S3, A11, A21);
+    sub<T>(S4, A12, S2);
+    sub<T>(T1, B12, B11);
+    sub<T>(T2, B22, T1);
+    sub<T>(T3, B22, B12);
+    sub<T>(T4, T2, B21);
+
+    TaskGroup group(*plan.pool);
+    auto product = [&group, &plan, depth](Block<const T> a, Block<const T> b, Block<T> c) {
+        group.run([a, b, c, &plan, depth] { multiply(a, b, c, plan, depth + 1); });
+    };
+    product(A11, B11, P1);
+    product(A12, B21, C11);
+    product(S4, B22, C12);
+    product(A22, T4, C21);
+    product(S1, T1, C22);
+    product(S2, T2, P6);
+    product(S3, T3, P7);
+    group.wait();
+
+    add<T>(P6, P1, P6);     // U2
+    add<T>(C12, P6, C12);   // U2 + P3
+    add<T>(C12, C12, C22);  // C12 = U2 + P3 + P5
+    add<T>(P6, P6, P7);     // U3
+    add<T>(C22, P6, C22);   // C22 = U3 + P5
+    sub<T>(C21, P6, C21);   // C21 = U3 - P4
+    add<T>(C11, P1, C11);   // C11 = P1 + P2
+}
+
+// The same products one after another, using C's quadrants as scratch, so each level needs
+// only X (shaped like A11), Y (like B11) and Z (like C11): the schedule of Douglas et al.,
+// "GEMMW: a portable level 3 BLAS Winograd variant of Strassen's matrix-matrix multiply".
+template <typename T>
+void winograd_sequential(Block<const T> A, Block<const T> B, Block<T> C, const Plan& plan, int depth) {
+    Block<const T> A11 = A.quad(0, 0), A12 = A.quad(0, 1), A21 = A.quad(1, 0), A22 = A.quad(1, 1);
+    Block<const T> B11 = B.quad(0, 0), B12 = B.quad(0, 1), B21 = B.quad(1, 0), B22 = B.quad(1, 1);
+    Block<T> C11 = C.quad(0, 0), C12 = C.quad(0, 1), C21 = C.quad(1, 0), C22 = C.quad(1, 1);
+    const int h = C11.rows, w = C11.cols, d = A11.cols;
+
+    Scratch<T> X(h, d, A.cs == 1), Y(d, w, B.cs == 1), Z(h, w, C.cs == 1);
+    const int next = depth + 1;
+
+    sub<T>(X, A11, A21);                    // S3
+    sub<T>(Y, B22, B12);                    // T3
+    multiply<T>(X, Y, C21, plan, next);     // C21 = P7
+    add<T>(X, A21, A22);                    // S1
+    sub<T>(Y, B12, B11);                    // T1
+    multiply<T>(X, Y, C22, plan, next);     // C22 = P5
+    sub<T>(X, X, A11);                      // S2
+    sub<T>(Y, B22, Y);                      // T2
+    multiply<T>(X, Y, C12, plan, next);     // C12 = P6
+    sub<T>(X, A12, X);                      // S4
+    multiply<T>(X, B22, C11, plan, next);   // C11 = P3
+    multiply<T>(A11, B11, Z, plan, next);   // Z = P1
+    add<T>(C12, Z, C12);                    // C12 = U2
+    add<T>(C21, C12, C21);                  // C21 = U3
+    add<T>(C12, C12, C22);                  // C12 = U2 + P5
+    add<T>(C22, C21, C22);                  // C22 = U3 + P5, final
+    add<T>(C12, C12, C11);                  // C12 = U2 + P5 + P3, final
+    sub<T>(Y, Y, B21);                      // T4
+    multiply<T>(A22, Y, C11, plan, next);   // C11 = P4
+    sub<T>(C21, C21, C11);                  // C21 = U3 - P4, final
+    multiply<T>(A12, B21, C11, plan, next); // C11 = P2
+    add<T>(C11, Z, C11);                    // C11 = P1 + P2, final
+}
+
+template <typename T>
+void multiply(Block<const T> A, Block<const T> B, Block<T> C, const Plan& plan, int depth) {
+    const int m = C.rows, n = C.cols, k = A.cols;
+    if (std::min({m, n, k}) <= plan.cutoff) {
+        gemm(m, n, k, A.p, A.rs, A.cs, B.p, B.rs, B.cs, C.p, C.rs, C.cs);
+        return;
+    }
+
+    // Strassen-Winograd on the even-sized top-left part ...
+    const int me = m & ~1, ne = n & ~1, ke = k & ~1;
+    Block<const T> Ae = A.top_left(me, ke), Be = B.top_left(ke, ne);
+    Block<T> Ce = C.top_left(me, ne);
+    if (depth < plan.parallel_depth)
+        winograd_parallel(Ae, Be, Ce, plan, depth);
+    else
+        winograd_sequential(Ae, Be, Ce, plan, depth);
+
+    // ... then the odd inner index as a rank-1 update, and the odd last column and row directly
+    if (k != ke) {
+        for (int i = 0; i < me; ++i) {
+            T a = A(i, k - 1);
+            for (int j = 0; j < ne; ++j)
+                Ce(i, j) += a * B(k - 1, j);
+        }
+    }
+    if (n != ne)
+        gemm(me, 1, k, A.p, A.rs, A.cs, B.p + ne * B.cs, B.rs, B.cs, C.p + ne * C.cs, C.rs, C.cs);
+    if (m != me)
+        gemm(1, n, k, A.p + me * A.rs, A.rs, A.cs, B.p, B.rs, B.cs, C.p + me * C.rs, C.rs, C.cs);
+}
+
+} // namespace
+
+template <typename T>
+void strassen_gemm(int m, int n, int k,
+                   const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                   const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                   T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc,
+                   int cutoff, ThreadPool* pool) {
+    Plan plan{std::max(cutoff, 1), pool, 0};
+    // enough parallel levels for about two products per thread (7^depth >= 2 * threads)
+    if (pool && pool->size() > 1)
+        for (size_t jobs = 1; jobs < 2 * pool->size(); jobs *= 7)
+            ++plan.parallel_depth;
+
+    multiply<T>({A, m, k, rsa, csa}, {B, k, n, rsb, csb}, {C, m, n, rsc, csc}, plan, 0);
+}
+
+// Explicit instantiation
+template void strassen_gemm<int>(int, int, int, const int*, std::ptrdiff_t, std::ptrdiff_t,
+                                 const int*, std::ptrdiff_t, std::ptrdiff_t, int*, std::ptrdiff_t, std::ptrdiff_t,
+                                 int, ThreadPool*);
+template void strassen_gemm<float>(int, int, int, const float*, std::ptrdiff_t, std::ptrdiff_t,
+                                   const float*, std::ptrdiff_t, std::ptrdiff_t, float*, std::ptrdiff_t, std::ptrdiff_t,
+                                   int, ThreadPool*);
+template void strassen_gemm<double>(int, int, int, const double*, std::ptrdiff_t, std::ptrdiff_t,
+                                    const double*, std::ptrdiff_t, std::ptrdiff_t, double*, std::ptrdiff_t, std::ptrdiff_t,
+                                    int, ThreadPool*);
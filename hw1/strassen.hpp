@@ -0,0 +1,25 @@
+#ifndef STRASSEN_HPP
+#define STRASSEN_HPP
+
+#include <cstddef>
+
+class ThreadPool;
+
+// C = A * B with the operand conventions of gemm(), by Strassen-Winograd: each level splits the
+// operands into quadrants and forms the product from 7 half-size products and 15 additions
+// instead of 8 products, recursing while m, n and k are all above `cutoff` and calling gemm()
+// below it. An odd last row, column or inner index is peeled off at each level.
+//
+// The top levels (enough for about two products per thread of `pool`) run their 7 products as
+// pool jobs, with 11 quarter-size temporaries per level; the levels below run them one after
+// another with 3. With pool == nullptr everything runs on the calling thread.
+// Exact for integers (as long as no partial sum overflows); for float and double the rounding
+// error grows with the number of levels.
+template <typename T>
+void strassen_gemm(int m, int n, int k,
+                   const T* A, std::ptrdiff_t rsa, std::ptrdiff_t csa,
+                   const T* B, std::ptrdiff_t rsb, std::ptrdiff_t csb,
+                   T* C, std::ptrdiff_t rsc, std::ptrdiff_t csc,
+                   int cutoff, ThreadPool* pool);
+
+#endif // STRASSEN_HPP
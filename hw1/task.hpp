@@ -0,0 +1,100 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Move-only void() callable for the thread pool. Callables up to kInlineSize bytes (a lambda
+// with a few references or values captured, a function pointer, a std::packaged_task) live
+// inside the Task, so building and moving one never allocates; bigger ones go to the heap.
+// Unlike std::function it takes move-only callables and is never copied.
+class Task {
+public:
+    static constexpr size_t kInlineSize = 40;
+
+    Task() noexcept = default;
+
+    template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>()) {
+            ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+            ops = &inline_ops<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage)) Fn*(new Fn(std::forward<F>(f)));
+            ops = &heap_ops<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept { take(other); }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void operator()() { ops->call(storage); }
+
+    // destroy the callable (and what it captured) now
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*call)(void*);
+        void (*move)(void* dst, void* src) noexcept;   // leaves src destroyed
+        void (*destroy)(void*) noexcept;
+    };
+
+    template <class Fn>
+    static constexpr bool fits_inline() {
+        return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <class Fn>
+    static inline const Ops inline_ops = {
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* dst, void* src) noexcept {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) noexcept { static_cast<Fn*>(p)->~Fn(); }
+    };
+
+    template <class Fn>
+    static inline const Ops heap_ops = {
+        [](void* p) { (**static_cast<Fn**>(p))(); },
+        [](void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* p) noexcept { delete *static_cast<Fn**>(p); }
+    };
+
+    void take(Task& other) noexcept {
+        ops = other.ops;
+        if (ops) {
+            ops->move(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[kInlineSize];
+    const Ops* ops = nullptr;
+};
+
+#endif
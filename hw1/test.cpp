@@ -5,6 +5,24 @@
 #include <thread>
 #include <condition_variable>
 #include <atomic>
+#include <cassert>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include <cstdlib>
+#include <new>
+
+// count every operator new, to check that small jobs are queued without allocating
+std::atomic<size_t> allocations(0);
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
 std::mutex cout_mutex;
 std::condition_variable cv;
@@ -40,6 +58,150 @@ struct print_2 {
     }
 };
 
+// submit / TaskGroup / parallel_for, including task groups nested inside pool jobs
+void test_futures_and_groups(ThreadPool& pool) {
+    std::future<int> answer = pool.submit([](int a, int b) { return a * b; }, 6, 7);
+    assert(answer.get() == 42 && "submit should deliver the job's result");
+
+    std::future<void> failing = pool.submit([] { throw std::runtime_error("job failed"); });
+    bool thrown = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && "submit should deliver the job's exception");
+
+    // parallel_for covers every index exactly once
+    std::vector<int> hits(10000, 0);
+    pool.parallel_for(0, hits.size(), 64, [&](size_t i) { ++hits[i]; });
+    assert(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }) && "parallel_for missed an index");
+
+    // nested groups: every outer job forks and joins its own parallel_for
+    std::atomic<long> sum(0);
+    TaskGroup outer(pool);
+    for (int block = 0; block < 8; ++block) {
+        outer.run([&pool, &sum, block] {
+            pool.parallel_for(block * 1000, (block + 1) * 1000, 100, [&sum](size_t i) { sum += static_cast<long>(i); });
+        });
+    }
+    outer.wait();
+    assert(sum == 7999L * 8000 / 2 && "nested task groups lost work");
+
+    std::cout << "submit / TaskGroup / parallel_for checks passed\n";
+}
+
+// capture-light jobs live inside Task and reuse pooled queue nodes: once the pool has warmed up,
+// a burst of them does not touch the heap
+void test_no_allocation(ThreadPool& pool) {
+    std::atomic<int> counter(0);
+    // Hold every worker while the burst is queued, so each burst needs all its nodes at once
+    // and the warm-up bursts already allocated as many as the measured one can use.
+    auto burst = [&] {
+        std::atomic<bool> open(false);
+        std::atomic<size_t> parked(0);
+        for (size_t w = 0; w < pool.size(); ++w) {
+            pool.enqueue([&] {
+                ++parked;
+                while (!open) std::this_thread::yield();
+            });
+        }
+        while (parked < pool.size()) std::this_thread::yield();
+
+        for (int k = 0; k < 1000; ++k)
+            pool.enqueue([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+        open = true;
+        pool.wait_all();
+    };
+    burst();
+    burst();
+
+    size_t before = allocations.load();
+    burst();
+    assert(allocations.load() == before && "enqueueing small jobs should not allocate");
+    assert(counter == 3000);
+
+    std::cout << "allocation-free enqueue check passed\n";
+}
+
+// BoundedRing specifics on a ring far smaller than the work: workers that went to sleep on the
+// futex wake for new jobs, a producer outside the pool blocks on a full ring until the workers
+// make room, and a worker filling the ring (or joining a TaskGroup) runs queued jobs meanwhile
+void test_ring() {
+    ThreadPool pool(4, ThreadPool::Scheduler::BoundedRing, 8);
+
+    // long enough for every worker to give up spinning and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int round = 0; round < 3; ++round) {
+        std::future<int> woken = pool.submit([round] { return round; });
+        assert(woken.wait_for(std::chrono::seconds(5)) == std::future_status::ready && "parked workers were not woken");
+        assert(woken.get() == round);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    // hold every worker so the ring fills and this thread has to wait for room
+    std::atomic<bool> open(false);
+    std::atomic<int> counter(0);
+    for (size_t w = 0; w < pool.size(); ++w)
+        pool.enqueue([&] { while (!open) std::this_thread::yield(); });
+    std::thread opener([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        open = true;
+    });
+    for (int k = 0; k < 200; ++k)
+        pool.enqueue([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+    opener.join();
+    pool.wait_all();
+    assert(counter == 200 && "a full ring lost jobs");
+
+    // a worker's own enqueues overflow the ring: it must run jobs itself instead of waiting
+    counter = 0;
+    pool.enqueue([&pool, &counter] {
+        for (int k = 0; k < 200; ++k)
+            pool.enqueue([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+    });
+    pool.wait_all();
+    assert(counter == 200 && "a worker filling the ring lost jobs");
+
+    // nested groups on a full ring only finish if waiting workers help
+    test_futures_and_groups(pool);
+    std::cout << "bounded ring checks passed\n";
+}
+
+// the per-worker counters account for every job run after a snapshot
+void test_stats(ThreadPool& pool) {
+    std::vector<ThreadPool::WorkerStats> before = pool.stats();
+    for (int k = 0; k < 1600; ++k)
+        pool.enqueue([] {});
+    pool.wait_all();
+    std::vector<ThreadPool::WorkerStats> after = pool.stats();
+
+    size_t tasks = 0, sampled = 0;
+    for (size_t w = 0; w < after.size(); ++w) {
+        tasks += after[w].tasks - before[w].tasks;
+        for (size_t k = 0; k < ThreadPool::kWaitBuckets; ++k)
+            sampled += after[w].wait_us[k] - before[w].wait_us[k];
+        assert(after[w].idle >= before[w].idle);
+    }
+    assert(tasks == 1600);
+    assert(sampled == 1600 / 64 && "one enqueue in 64 from this thread is timed");
+
+    pool.print_stats(std::cout);
+}
+
+// A pool with nothing to do is idle, including the sleep its workers are in right now
+void test_idle_stats(ThreadPool& pool) {
+    pool.wait_all();
+    std::vector<ThreadPool::WorkerStats> before = pool.stats();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    std::vector<ThreadPool::WorkerStats> after = pool.stats();
+    for (size_t w = 0; w < after.size(); ++w) {
+        auto idle = after[w].idle - before[w].idle, busy = after[w].busy - before[w].busy;
+        assert(idle >= busy && "an idle worker counted as busy");
+        assert(idle.count() > 0.2);
+    }
+}
+
 int main() {
     ThreadPool pool(5); // build a thread pool with 5 threads
 
@@ -56,7 +218,22 @@ int main() {
     }
 
     // wait for all tasks to complete
-    std::this_thread::sleep_for(std::chrono::seconds(3));
+    pool.wait_all();
+
+    // the same checks on a fresh pool of every scheduler
+    const ThreadPool::Scheduler schedulers[] = {
+        ThreadPool::Scheduler::WorkStealing, ThreadPool::Scheduler::SharedQueue, ThreadPool::Scheduler::BoundedRing
+    };
+    const char* names[] = {"stealing", "shared", "ring"};
+    for (size_t s = 0; s < 3; ++s) {
+        std::cout << "\n[" << names[s] << "]\n";
+        ThreadPool checked(5, schedulers[s]);
+        test_futures_and_groups(checked);
+        test_no_allocation(checked);
+        test_stats(checked);
+        test_idle_stats(checked);
+    }
+    test_ring();
 
     return 0;
 }
\ No newline at end of file
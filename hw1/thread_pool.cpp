@@ -1,38 +1,92 @@
 #include "thread_pool.hpp"
+#include <iomanip>
+#include <string>
 
-ThreadPool::ThreadPool(size_t threads) : stop(false), 
-    thread_run_times(threads),
+namespace {
+// the pool and index of the worker running on this thread, so that enqueue() from inside a job
+// can push to that worker's own deque
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker = 0;
+
+// most external jobs a worker moves to its own deque per visit to the shared queue
+constexpr size_t kMaxInjectedBatch = 64;
+
+// BoundedRing: ring polls before an idle worker or a blocked producer parks (a few microseconds);
+// with a single CPU, spinning only keeps the thread we wait for off it
+const int kSpinCount = std::thread::hardware_concurrency() > 1 ? 256 : 1;
+
+// queue wait is timed for one enqueue in 64 per thread; a clock read per job would show up
+constexpr unsigned kWaitSampleMask = 63;
+thread_local unsigned enqueue_tick = 0;
+
+std::chrono::steady_clock::time_point sample_enqueue_time() {
+    return (++enqueue_tick & kWaitSampleMask) == 0 ? std::chrono::steady_clock::now()
+                                                   : std::chrono::steady_clock::time_point{};
+}
+
+// power-of-two microsecond bucket, see WorkerStats::wait_us
+size_t wait_bucket(std::chrono::steady_clock::duration wait) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(wait).count();
+    size_t bucket = 0;
+    while (us > 0 && bucket + 1 < ThreadPool::kWaitBuckets) {
+        us >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+// counters written by one thread only: a plain load + store instead of a locked add
+inline void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+// a steady-clock reading as a count of nanoseconds, which fits in an atomic
+inline uint64_t clock_ns(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+}
+
+ThreadPool::ThreadPool(size_t threads, Scheduler scheduler, size_t ring_capacity) : scheduler(scheduler), stop(false),
+    thread_run_times(threads), started(Clock::now()),
     worker_ids(threads) // Initialize the worker_ids size with the number of threads
 {
+    for (size_t i = 0; i < threads; ++i)
+        queues.push_back(std::make_unique<Worker>(i));
+    if (scheduler == Scheduler::BoundedRing) {
+        ring = std::make_unique<MpmcQueue<Queued>>(ring_capacity);
+        parked_workers.reserve(threads);
+    }
+
     for (size_t i = 0; i < threads; ++i) {
         workers.emplace_back([this, i] {
-            
+
             // Store the thread id of each worker
             {
                 // use ids_mutex to protect the worker_ids <or it will stack smashing>
                 std::lock_guard<std::mutex> lock(this->ids_mutex);
                 worker_ids[i] = std::this_thread::get_id();
             }
+            current_pool = this;
+            current_worker = i;
             auto start_time = std::chrono::high_resolution_clock::now();
-            
-            while (true) {
-                std::function<void()> job;
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this] { return this->stop || !this->jobs.empty(); });
-
-                    if (this->stop && this->jobs.empty()) {
-                        auto end_time = std::chrono::high_resolution_clock::now();
-                        thread_run_times[i] = end_time - start_time;
-                        return;
-                    }
-
-                    job = std::move(this->jobs.front());
-                    this->jobs.pop();
-                }
-
-                job();
-            }
+
+            if (this->scheduler == Scheduler::SharedQueue)
+                run_shared(i);
+            else if (this->scheduler == Scheduler::BoundedRing)
+                run_ring(i);
+            else
+                run_stealing(i);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            thread_run_times[i] = end_time - start_time;
         });
     }
 }
@@ -43,7 +97,9 @@ ThreadPool::~ThreadPool() {
         stop = true;
     }
     condition.notify_all();
-    
+    if (scheduler == Scheduler::BoundedRing)
+        unpark_all();
+
     for (size_t i = 0; i < workers.size(); ++i) {
         workers[i].join();
         std::cout << "\nThread " << worker_ids[i]
@@ -51,10 +107,417 @@ ThreadPool::~ThreadPool() {
     }
 }
 
-void ThreadPool::enqueue(std::function<void()> job) {
-    {
+void ThreadPool::enqueue(Task task) {
+    unfinished.fetch_add(1);
+    Clock::time_point queued = sample_enqueue_time();
+    if (scheduler == Scheduler::BoundedRing) {
+        Queued job;
+        job.task = std::move(task);
+        job.queued = queued;
+        push_ring(job);
+        return;
+    }
+
+    bool inside = current_pool == this;
+    Job* job = inside ? queues[current_worker]->nodes.get() : nullptr;
+
+    if (scheduler == Scheduler::SharedQueue) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            if (!job) job = outside_nodes.get();
+            job->task = std::move(task);
+            job->queued = queued;
+            push_shared(job);
+        }
+        condition.notify_one();
+        return;
+    }
+
+    // counted before the push, so `pending` never drops below the jobs really queued
+    pending.fetch_add(1);
+    if (inside) {
+        Worker* self = queues[current_worker].get();
+        job->task = std::move(task);
+        job->queued = queued;
+        self->deque.push(job);
+        note_depth(self, self->deque.size());
+    } else {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        job = outside_nodes.get();
+        job->task = std::move(task);
+        job->queued = queued;
+        push_shared(job);
+    }
+
+    // A worker going to sleep bumps `sleeping` before it checks `pending` (both seq_cst),
+    // so either it sees this job or we see it and wake it up.
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        condition.notify_one();
+    }
+}
+
+void ThreadPool::wait_all() {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    all_done.wait(lock, [this] { return unfinished.load() == 0; });
+}
+
+void ThreadPool::finish_job() {
+    if (unfinished.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        all_done.notify_all();
+    }
+}
+
+void ThreadPool::run_shared(size_t i) {
+    while (true) {
+        Job* job;
+        {
+            std::unique_lock<std::mutex> lock(this->queue_mutex);
+            if (!this->stop && !this->jobs_head) {
+                auto idle_start = begin_idle(i);
+                this->condition.wait(lock, [this] { return this->stop || this->jobs_head; });
+                end_idle(i, idle_start);
+            }
+
+            if (this->stop && !this->jobs_head)
+                return;
+
+            note_depth(queues[i].get(), jobs_count);
+            job = pop_shared();
+        }
+
+        run_job(job, queues[i].get());
+    }
+}
+
+// Run, then release the captures before the node goes back and the job counts as finished
+void ThreadPool::run_job(Job* job, Worker* self) {
+    execute(*job, self);
+    JobPool::put(job);
+    finish_job();
+}
+
+// run a job on the calling thread, counted for the worker if it is one of ours
+void ThreadPool::execute(Queued& job, Worker* self) {
+    if (self) {
+        bump(self->tasks);
+        if (job.queued != Clock::time_point{})
+            bump(self->wait_us[wait_bucket(Clock::now() - job.queued)]);
+    }
+    job.task();
+    job.task.reset();
+}
+
+void ThreadPool::note_depth(Worker* self, size_t depth) {
+    if (self && depth > self->max_depth.load(std::memory_order_relaxed))
+        self->max_depth.store(depth, std::memory_order_relaxed);
+}
+
+ThreadPool::Clock::time_point ThreadPool::begin_idle(size_t i) {
+    auto now = Clock::now();
+    queues[i]->idle_since_ns.store(clock_ns(now), std::memory_order_relaxed);
+    return now;
+}
+
+// The open spell is closed before it is added (release), and stats() reads the total before the
+// open spell (acquire), so it may miss a spell for a moment but never counts one twice.
+void ThreadPool::end_idle(size_t i, Clock::time_point since) {
+    Worker& w = *queues[i];
+    w.idle_since_ns.store(0, std::memory_order_relaxed);
+    uint64_t total = w.idle_ns.load(std::memory_order_relaxed) + (clock_ns(Clock::now()) - clock_ns(since));
+    w.idle_ns.store(total, std::memory_order_release);
+}
+
+void ThreadPool::run_stealing(size_t i) {
+    while (true) {
+        if (Job* job = find_job(i)) {
+            run_job(job, queues[i].get());
+            continue;
+        }
+
         std::unique_lock<std::mutex> lock(queue_mutex);
-        jobs.emplace(job);
+        if (stop && pending.load() == 0)
+            return;
+        auto idle_start = begin_idle(i);
+        sleeping.fetch_add(1);
+        condition.wait(lock, [this] { return stop || pending.load() > 0; });
+        sleeping.fetch_sub(1);
+        end_idle(i, idle_start);
+    }
+}
+
+void ThreadPool::run_ring(size_t i) {
+    Worker* self = queues[i].get();
+    Queued job;
+    while (true) {
+        if (!pop_ring(job, self)) {
+            auto idle_start = begin_idle(i);
+            if (!wait_ring(i, job))
+                return;
+            end_idle(i, idle_start);
+        }
+        execute(job, self);
+        finish_job();
+    }
+}
+
+// Spin on the ring for a while, then park until a producer claims this worker. False once the
+// pool is stopping and the ring is empty.
+bool ThreadPool::wait_ring(size_t i, Queued& job) {
+    Worker& self = *queues[i];
+    while (true) {
+        for (int spin = 0; spin < kSpinCount; ++spin) {
+            if (pop_ring(job, &self))
+                return true;
+            cpu_relax();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+            self.parked.store(1, std::memory_order_relaxed);
+            parked_workers.push_back(i);
+            num_parked.fetch_add(1);
+        }
+        // Re-check after announcing ourselves (seq_cst against the fence in unpark_one): either
+        // we see the producer's job or it sees us parked.
+        bool found = pop_ring(job, &self);
+        if (!found && !stop.load()) {
+            while (self.parked.load(std::memory_order_acquire))
+                futex_wait(self.parked, 1);
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+            if (self.parked.load(std::memory_order_relaxed)) {   // nobody claimed us meanwhile
+                parked_workers.erase(std::find(parked_workers.begin(), parked_workers.end(), i));
+                num_parked.fetch_sub(1);
+                self.parked.store(0, std::memory_order_relaxed);
+            }
+        }
+        return found;
+    }
+}
+
+void ThreadPool::unpark_one() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (num_parked.load(std::memory_order_relaxed) == 0)
+        return;
+    Worker* worker;
+    {
+        std::lock_guard<std::mutex> lock(park_mutex);
+        if (parked_workers.empty())
+            return;
+        worker = queues[parked_workers.back()].get();
+        parked_workers.pop_back();
+        num_parked.fetch_sub(1);
+        worker->parked.store(0, std::memory_order_release);
+    }
+    // a stray wake if the worker already got up on its own; it goes back to sleep
+    futex_wake(worker->parked, 1);
+}
+
+void ThreadPool::unpark_all() {
+    std::lock_guard<std::mutex> lock(park_mutex);
+    for (size_t i : parked_workers) {
+        queues[i]->parked.store(0, std::memory_order_release);
+        futex_wake(queues[i]->parked, 1);
+    }
+    parked_workers.clear();
+    num_parked.store(0);
+}
+
+// Backpressure: while the ring is full, a producer outside the pool spins, then parks until the
+// workers have drained half of it. A worker runs queued jobs instead, since every worker may be a producer.
+void ThreadPool::push_ring(Queued& job) {
+    for (int spin = 0; !ring->try_push(job); ++spin) {
+        if (current_pool == this) {
+            if (!run_one()) cpu_relax();
+            continue;
+        }
+        if (spin < kSpinCount) {
+            cpu_relax();
+            continue;
+        }
+        uint32_t key = ring_space.prepare_wait();
+        if (ring->try_push(job)) {
+            ring_space.cancel_wait();
+            break;
+        }
+        ring_space.commit_wait(key);
+    }
+    unpark_one();
+}
+
+// Blocked producers are woken once the ring is half empty rather than for every free slot, so
+// a producer refills it in one go instead of a futex round trip per job.
+bool ThreadPool::pop_ring(Queued& job, Worker* self) {
+    if (!ring->try_pop(job))
+        return false;
+    size_t left = ring->size();
+    if (left <= ring->capacity() / 2)
+        ring_space.notify_all();
+    note_depth(self, left + 1);
+    return true;
+}
+
+// Next job for worker i (i == queues.size() for a thread outside the pool): own newest job
+// first, then the oldest external one, then someone else's oldest.
+ThreadPool::Job* ThreadPool::find_job(size_t i) {
+    bool worker = i < queues.size();
+    Job* job = worker ? queues[i]->deque.pop() : nullptr;
+    if (!job) {
+        // Take a fair share of the external jobs per lock; the extra ones go to the own
+        // deque, where idle workers can still steal them.
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (worker) note_depth(queues[i].get(), jobs_count);
+        size_t share = worker ? std::min<size_t>(jobs_count / queues.size() + 1, kMaxInjectedBatch) : 1;
+        for (size_t k = 0; k < share && jobs_head; ++k) {
+            if (k == 0) job = pop_shared();
+            else queues[i]->deque.push(pop_shared());
+        }
+    }
+    if (!job)
+        job = steal(i);
+    if (job)
+        pending.fetch_sub(1);
+    return job;
+}
+
+ThreadPool::Job* ThreadPool::steal(size_t thief) {
+    size_t n = queues.size();
+    size_t first = thief < n ? queues[thief]->rng() % n : 0;
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (first + k) % n;
+        if (victim == thief) continue;
+        if (Job* job = queues[victim]->deque.steal()) {
+            if (thief < n) bump(queues[thief]->steals);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadPool::run_one() {
+    Worker* self = current_pool == this ? queues[current_worker].get() : nullptr;
+    if (scheduler == Scheduler::BoundedRing) {
+        Queued job;
+        if (!pop_ring(job, self))
+            return false;
+        execute(job, self);
+        finish_job();
+        return true;
+    }
+
+    Job* job;
+    if (scheduler == Scheduler::SharedQueue) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        note_depth(self, jobs_count);
+        job = jobs_head ? pop_shared() : nullptr;
+    } else {
+        job = find_job(self ? current_worker : queues.size());
+    }
+    if (!job)
+        return false;
+    run_job(job, self);
+    return true;
+}
+
+void ThreadPool::push_shared(Job* job) {
+    job->next = nullptr;
+    if (jobs_tail) jobs_tail->next = job;
+    else jobs_head = job;
+    jobs_tail = job;
+    ++jobs_count;
+}
+
+ThreadPool::Job* ThreadPool::pop_shared() {
+    Job* job = jobs_head;
+    jobs_head = job->next;
+    if (!jobs_head) jobs_tail = nullptr;
+    --jobs_count;
+    return job;
+}
+
+ThreadPool::Job* ThreadPool::JobPool::get() {
+    if (!free_list)
+        free_list = returned.exchange(nullptr, std::memory_order_acquire);
+    if (!free_list) {
+        chunks.push_back(std::make_unique<Job[]>(kChunk));
+        Job* chunk = chunks.back().get();
+        for (size_t k = 0; k < kChunk; ++k) {
+            chunk[k].home = this;
+            chunk[k].next = k + 1 < kChunk ? &chunk[k + 1] : nullptr;
+        }
+        free_list = chunk;
     }
-    condition.notify_one();
-}
\ No newline at end of file
+    Job* job = free_list;
+    free_list = job->next;
+    job->next = nullptr;
+    return job;
+}
+
+void ThreadPool::JobPool::put(Job* job) {
+    JobPool* home = job->home;
+    Job* head = home->returned.load(std::memory_order_relaxed);
+    do {
+        job->next = head;
+    } while (!home->returned.compare_exchange_weak(head, job, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+}
+
+std::vector<ThreadPool::WorkerStats> ThreadPool::stats() const {
+    auto now = Clock::now();
+    const uint64_t now_ns = clock_ns(now);
+    auto elapsed = std::chrono::duration<double>(now - started);
+    std::vector<WorkerStats> all(queues.size());
+    for (size_t i = 0; i < queues.size(); ++i) {
+        const Worker& w = *queues[i];
+        WorkerStats& st = all[i];
+        {
+            std::lock_guard<std::mutex> lock(ids_mutex);
+            st.id = worker_ids[i];
+        }
+        st.tasks = w.tasks.load(std::memory_order_relaxed);
+        st.steals = w.steals.load(std::memory_order_relaxed);
+        st.max_queue_depth = w.max_depth.load(std::memory_order_relaxed);
+        // finished idle spells, plus the one the worker may be in right now
+        uint64_t idle_ns = w.idle_ns.load(std::memory_order_acquire);
+        if (uint64_t since = w.idle_since_ns.load(std::memory_order_relaxed))
+            idle_ns += std::max(now_ns, since) - since;
+        st.idle = std::min(std::chrono::duration<double>(std::chrono::nanoseconds(idle_ns)), elapsed);
+        st.busy = elapsed - st.idle;
+        for (size_t k = 0; k < kWaitBuckets; ++k)
+            st.wait_us[k] = w.wait_us[k].load(std::memory_order_relaxed);
+    }
+    return all;
+}
+
+// one line per worker; the queue wait is given as the bucket holding the median and the 99th
+// percentile of the sampled jobs ("<8" = under 8 us)
+void ThreadPool::print_stats(std::ostream& os) const {
+    auto bucket_name = [](size_t k) {
+        return k + 1 == kWaitBuckets ? ">=" + std::to_string(1u << (k - 1)) : "<" + std::to_string(1u << k);
+    };
+    std::vector<WorkerStats> all = stats();
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << "worker     tasks   steals  max depth   busy(s)   idle(s)   wait p50  wait p99 (us)\n";
+    for (size_t i = 0; i < all.size(); ++i) {
+        const WorkerStats& st = all[i];
+        size_t samples = 0;
+        for (size_t n : st.wait_us) samples += n;
+        std::string p50 = "-", p99 = "-";
+        for (size_t k = 0, seen = 0; k < kWaitBuckets && samples; ++k) {
+            seen += st.wait_us[k];
+            if (p50 == "-" && 2 * seen >= samples) p50 = bucket_name(k);
+            if (p99 == "-" && 100 * seen >= 99 * samples) p99 = bucket_name(k);
+        }
+        os << std::setw(6) << i << std::setw(10) << st.tasks << std::setw(9) << st.steals
+           << std::setw(11) << st.max_queue_depth << std::fixed << std::setprecision(3)
+           << std::setw(10) << st.busy.count() << std::setw(10) << st.idle.count()
+           << std::setw(11) << p50 << std::setw(10) << p99 << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -1,7 +1,6 @@
 #ifndef THREAD_POOL_HPP
 #define THREAD_POOL_HPP
 
-#include <queue>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -9,31 +8,276 @@
 #include <vector>
 #include <chrono>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <future>
+#include <type_traits>
+#include <exception>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <ostream>
+
+#include "event_count.hpp"
+#include "mpmc_queue.hpp"
+#include "task.hpp"
+#include "work_stealing_deque.hpp"
 
 class ThreadPool {
 public:
-    ThreadPool(size_t threads = 5);
+    // how the workers get their jobs
+    enum class Scheduler {
+        // one job queue behind one mutex (the original design)
+        SharedQueue,
+        // a Chase-Lev deque per worker plus random-victim stealing; a job submitted from a worker
+        // goes to that worker's deque, so only jobs from outside the pool touch the mutex
+        WorkStealing,
+        // one bounded lock-free MPMC ring of `ring_capacity` tasks; idle workers spin briefly, then
+        // park on a futex, and enqueue() only locks to wake one of them. enqueue() waits while the
+        // ring is full (a worker runs queued jobs instead), so producers cannot run ahead of the
+        // pool without bound.
+        BoundedRing
+    };
+
+    ThreadPool(size_t threads = 5, Scheduler scheduler = Scheduler::WorkStealing,
+               size_t ring_capacity = 1024);
     ~ThreadPool();
-    
-    // use for commit a job to the thread pool
-    void enqueue(std::function<void()> job);
+
+    // use for commit a job to the thread pool (any callable; small ones are stored without allocating)
+    void enqueue(Task job);
+
+    // commit f(args...) and get its result (or exception) through the future
+    template <class F, class... Args>
+    auto submit(F&& f, Args&&... args)
+        -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>>;
+
+    // block until every job committed so far has finished, including the jobs those jobs commit;
+    // only from outside the pool (a job waiting for itself never returns), use TaskGroup inside
+    void wait_all();
+
+    // fn(i) for every i in [begin, end), in jobs of `grain` indices; returns when all are done.
+    // Safe from inside a job: the caller runs pending jobs while it waits.
+    template <class Fn>
+    void parallel_for(size_t begin, size_t end, size_t grain, Fn fn);
+
+    size_t size() const { return workers.size(); }
+
+    static constexpr size_t kWaitBuckets = 20;
+
+    // what one worker has been doing since the pool started
+    struct WorkerStats {
+        std::thread::id id;
+        size_t tasks = 0;               // jobs run, including those run while helping a TaskGroup
+        size_t steals = 0;              // jobs taken from another worker's deque (WorkStealing)
+        size_t max_queue_depth = 0;     // most jobs seen waiting in the queue it took a job from
+        std::chrono::duration<double> busy{0};   // running jobs or looking for one
+        std::chrono::duration<double> idle{0};   // spinning or asleep with nothing to run
+        // queue wait (enqueue until start) of every 64th job: bucket 0 counts waits under 1 us,
+        // bucket k those in [2^(k-1), 2^k) us, and the last one everything slower
+        std::array<size_t, kWaitBuckets> wait_us{};
+    };
+
+    // Snapshot of every worker's counters, from any thread. Each worker updates its own with
+    // relaxed stores, so on a live pool the numbers may be a few jobs apart.
+    std::vector<WorkerStats> stats() const;
+    void print_stats(std::ostream& os) const;
 
 private:
+    friend class TaskGroup;
+
+    class JobPool;
+    using Clock = std::chrono::steady_clock;
+
+    // what waits in a queue: BoundedRing moves these through its ring by value
+    struct Queued {
+        Task task;
+        Clock::time_point queued{};   // set for the jobs whose queue wait is sampled
+    };
+
+    // a queued job: a pooled node, linked into the shared queue or held by a worker's deque
+    struct Job : Queued {
+        Job* next = nullptr;
+        JobPool* home = nullptr;
+    };
+
+    // Job nodes are recycled instead of allocated per enqueue. A worker takes nodes from its own
+    // pool without locking; threads outside the pool share one under queue_mutex. Whoever runs
+    // a job hands the node back to its home pool through a lock-free stack, which the owner
+    // drains in a single exchange (so there is no ABA problem).
+    class JobPool {
+    public:
+        Job* get();
+        static void put(Job* job);
+
+    private:
+        static constexpr size_t kChunk = 256;
+        Job* free_list = nullptr;
+        std::atomic<Job*> returned{nullptr};
+        std::vector<std::unique_ptr<Job[]>> chunks;
+    };
+
+    struct Worker {
+        explicit Worker(size_t seed) : rng(static_cast<unsigned>(seed) + 1) {}
+        WorkStealingDeque<Job> deque;   // WorkStealing only
+        JobPool nodes;
+        std::minstd_rand rng;           // picks the first steal victim
+        std::atomic<uint32_t> parked{0};  // BoundedRing: futex word, 1 while asleep and unclaimed
+
+        // statistics, stored by this worker only (relaxed load + store, no locked instruction)
+        std::atomic<uint64_t> tasks{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> max_depth{0};
+        std::atomic<uint64_t> idle_ns{0};        // finished idle spells
+        std::atomic<uint64_t> idle_since_ns{0};  // start of the current one (clock_ns), 0 when busy
+        std::array<std::atomic<uint64_t>, kWaitBuckets> wait_us{};
+    };
+
+    void run_shared(size_t i);
+    void run_stealing(size_t i);
+    void run_ring(size_t i);
+    bool wait_ring(size_t i, Queued& job);
+    // `self` is the calling worker, nullptr for a thread outside the pool
+    void run_job(Job* job, Worker* self);
+    void execute(Queued& job, Worker* self);
+    static void note_depth(Worker* self, size_t depth);
+    // bracket a spell of worker i with nothing to run; stats() sees it while it lasts
+    Clock::time_point begin_idle(size_t i);
+    void end_idle(size_t i, Clock::time_point since);
+    Job* find_job(size_t i);
+    Job* steal(size_t thief);
+    // run one queued job on the calling thread, false when none was found
+    bool run_one();
+    void finish_job();
+
+    // the shared FIFO, guarded by queue_mutex
+    void push_shared(Job* job);
+    Job* pop_shared();
+
+    // BoundedRing: push waits for room, pop tells a waiting producer there is some
+    void push_ring(Queued& job);
+    bool pop_ring(Queued& job, Worker* self);
+    // the producer claims a parked worker (takes it off the list) before waking it, so further
+    // pushes see no one parked and skip the syscall until the worker runs out of work again
+    void unpark_one();
+    void unpark_all();
+
+    Scheduler scheduler;
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> jobs;
-    
+    std::vector<std::unique_ptr<Worker>> queues;
+
+    // SharedQueue: every job; WorkStealing: jobs from outside the pool. Linked through Job::next.
+    Job* jobs_head = nullptr;
+    Job* jobs_tail = nullptr;
+    size_t jobs_count = 0;
+    JobPool outside_nodes;                 // guarded by queue_mutex
+
+    // WorkStealing only
+    std::atomic<size_t> pending{0};        // jobs pushed and not yet taken
+    std::atomic<size_t> sleeping{0};       // workers waiting on `condition`
+
+    // BoundedRing only
+    std::unique_ptr<MpmcQueue<Queued>> ring;
+    std::atomic<size_t> num_parked{0};     // size of parked_workers, read without the lock
+    std::vector<size_t> parked_workers;    // guarded by park_mutex
+    std::mutex park_mutex;
+    EventCount ring_space;                 // producers wait for a free slot
+
     std::mutex queue_mutex;
     std::condition_variable condition;
-    bool stop;
+    std::atomic<bool> stop;                // atomic for the BoundedRing workers, which hold no lock
+
+    // jobs committed and not finished yet, for wait_all()
+    std::atomic<size_t> unfinished{0};
+    std::condition_variable all_done;
 
     // store the run time of each thread
     std::vector<std::chrono::duration<double>> thread_run_times;
+    Clock::time_point started;
 
     // store the thread id of each worker
     std::vector<std::thread::id> worker_ids;
 
     // mutex to protect the worker_ids
-    std::mutex ids_mutex;
+    mutable std::mutex ids_mutex;
+};
+
+// A set of jobs to wait for together, independent of whatever else the pool is running.
+// wait() runs other pending jobs while it waits, so jobs can fork and join groups of their own.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { wait_quietly(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <class F>
+    void run(F&& f) {
+        unfinished.fetch_add(1);
+        pool.enqueue([this, job = std::forward<F>(f)]() mutable {
+            try {
+                job();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (unfinished.fetch_sub(1) == 1) done.notify_all();
+        });
+    }
+
+    // wait for every job run() so far; rethrows the first exception one of them threw
+    void wait() {
+        wait_quietly();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+private:
+    void wait_quietly() {
+        while (unfinished.load() > 0) {
+            if (pool.run_one()) continue;
+            // nothing to help with: our jobs are running elsewhere, or about to be queued
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait_for(lock, std::chrono::milliseconds(1), [this] { return unfinished.load() == 0; });
+        }
+        // the last job may still hold `mutex` right after its decrement
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+
+    ThreadPool& pool;
+    std::atomic<size_t> unfinished{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
 };
 
-#endif
\ No newline at end of file
+template <class F, class... Args>
+auto ThreadPool::submit(F&& f, Args&&... args)
+    -> std::future<std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>> {
+    using R = std::invoke_result_t<std::decay_t<F>, std::decay_t<Args>...>;
+    std::packaged_task<R()> task(
+        [f = std::forward<F>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            return std::apply(std::move(f), std::move(args));
+        });
+    std::future<R> result = task.get_future();
+    enqueue(std::move(task));
+    return result;
+}
+
+template <class Fn>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, Fn fn) {
+    if (grain == 0) grain = 1;
+    TaskGroup group(*this);
+    for (size_t lo = begin; lo < end; lo += grain) {
+        size_t hi = std::min(end, lo + grain);
+        group.run([&fn, lo, hi] {
+            for (size_t i = lo; i < hi; ++i) fn(i);
+        });
+    }
+    group.wait();
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include "transpose.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr int kBlock = 32;
+
+// W x W sub-tiles, one 16-byte vector per row
+template <typename T>
+struct Lanes {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "4- or 8-byte elements");
+    static constexpr int W = 16 / sizeof(T);
+    typedef T V __attribute__((vector_size(16)));
+};
+
+template <typename V>
+inline V load(const void* p) {
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <typename V>
+inline void store(void* p, V v) { std::memcpy(p, &v, sizeof(V)); }
+
+// Move the W x W sub-tile at src (rows src_ld apart) to dst as its transpose (rows dst_ld
+// apart): W loads, a shuffle network, W stores, with every row held in a named register.
+template <typename T>
+inline void transpose_tile(const T* src, size_t src_ld, T* dst, size_t dst_ld) {
+    using V = typename Lanes<T>::V;
+    if constexpr (Lanes<T>::W == 4) {
+        using M = int __attribute__((vector_size(16)));
+        V r0 = load<V>(src), r1 = load<V>(src + src_ld);
+        V r2 = load<V>(src + 2 * src_ld), r3 = load<V>(src + 3 * src_ld);
+        V t0 = __builtin_shuffle(r0, r1, M{0, 4, 1, 5});
+        V t1 = __builtin_shuffle(r0, r1, M{2, 6, 3, 7});
+        V t2 = __builtin_shuffle(r2, r3, M{0, 4, 1, 5});
+        V t3 = __builtin_shuffle(r2, r3, M{2, 6, 3, 7});
+        store(dst, __builtin_shuffle(t0, t2, M{0, 1, 4, 5}));
+        store(dst + dst_ld, __builtin_shuffle(t0, t2, M{2, 3, 6, 7}));
+        store(dst + 2 * dst_ld, __builtin_shuffle(t1, t3, M{0, 1, 4, 5}));
+        store(dst + 3 * dst_ld, __builtin_shuffle(t1, t3, M{2, 3, 6, 7}));
+    } else {
+        using M = long long __attribute__((vector_size(16)));
+        V r0 = load<V>(src), r1 = load<V>(src + src_ld);
+        store(dst, __builtin_shuffle(r0, r1, M{0, 2}));
+        store(dst + dst_ld, __builtin_shuffle(r0, r1, M{1, 3}));
+    }
+}
+
+// Swap the sub-tiles at p and q, each one transposed on the way (p == q transposes in place)
+template <typename T>
+inline void swap_tiles(T* p, T* q, size_t ld) {
+    constexpr int W = Lanes<T>::W;
+    alignas(16) T tmp[W * W];
+    transpose_tile(p, ld, tmp, W);
+    if (p != q) transpose_tile(q, ld, p, ld);
+    for (int i = 0; i < W; ++i)
+        std::memcpy(q + i * ld, tmp + i * W, sizeof(T) * W);
+}
+
+} // namespace
+
+template <typename T>
+void transpose(int rows, int cols, const T* src, size_t src_ld, T* dst, size_t dst_ld) {
+    constexpr int W = Lanes<T>::W;
+
+    for (int ib = 0; ib < rows; ib += kBlock) {
+        const int i_end = std::min(rows, ib + kBlock);
+        for (int jb = 0; jb < cols; jb += kBlock) {
+            const int j_end = std::min(cols, jb + kBlock);
+            int i = ib;
+            for (; i + W <= i_end; i += W) {
+                int j = jb;
+                for (; j + W <= j_end; j += W)
+                    transpose_tile(src + i * src_ld + j, src_ld, dst + j * dst_ld + i, dst_ld);
+                for (; j < j_end; ++j)
+                    for (int w = 0; w < W; ++w)
+                        dst[j * dst_ld + i + w] = src[(i + w) * src_ld + j];
+            }
+            for (; i < i_end; ++i)
+                for (int j = jb; j < j_end; ++j)
+                    dst[j * dst_ld + i] = src[i * src_ld + j];
+        }
+    }
+}
+
+template <typename T>
+void transpose_square(int n, T* a, size_t ld) {
+    constexpr int W = Lanes<T>::W;
+    const int n_tiles = n - n % W;   // the part covered by whole sub-tiles
+
+    // sub-tile (i, j) above the diagonal trades places with (j, i), each one transposed;
+    // block by block, so that both stay in cache
+    for (int ib = 0; ib < n_tiles; ib += kBlock) {
+        const int i_end = std::min(n_tiles, ib + kBlock);
+        for (int jb = ib; jb < n_tiles; jb += kBlock) {
+            const int j_end = std::min(n_tiles, jb + kBlock);
+            for (int i = ib; i < i_end; i += W)
+                for (int j = std::max(jb, i); j < j_end; j += W)
+                    swap_tiles(a + i * ld + j, a + j * ld + i, ld);
+        }
+    }
+    // the last n % W rows against everything before them, and their own corner
+    for (int i = n_tiles; i < n; ++i)
+        for (int j = 0; j < i; ++j)
+            std::swap(a[i * ld + j], a[j * ld + i]);
+}
+
+// Explicit instantiation
+template void transpose<int>(int, int, const int*, size_t, int*, size_t);
+template void transpose<float>(int, int, const float*, size_t, float*, size_t);
+template void transpose<double>(int, int, const double*, size_t, double*, size_t);
+template void transpose_square<int>(int, int*, size_t);
+template void transpose_square<float>(int, float*, size_t);
+template void transpose_square<double>(int, double*, size_t);
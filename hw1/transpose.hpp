@@ -0,0 +1,21 @@
+#ifndef TRANSPOSE_HPP
+#define TRANSPOSE_HPP
+
+#include <cstddef>
+
+// dst = src^T for a rows x cols matrix stored by rows at src (row i at src + i * src_ld);
+// dst receives it by columns (column i at dst + i * dst_ld). The same call converts a
+// column-major matrix to row-major, with rows and cols swapped. src and dst must not overlap.
+//
+// Cache-blocked: the matrix is walked in kBlock x kBlock tiles, small enough that a tile of src
+// and one of dst stay in L1, and each tile is moved as W x W sub-tiles (one 16-byte vector per
+// row, W = 4 for int and float, 2 for double) that are transposed in registers with shuffles.
+// Instantiated for int, float and double.
+template <typename T>
+void transpose(int rows, int cols, const T* src, size_t src_ld, T* dst, size_t dst_ld);
+
+// a = a^T in place, for the n x n matrix with rows (or columns) ld apart
+template <typename T>
+void transpose_square(int n, T* a, size_t ld);
+
+#endif // TRANSPOSE_HPP
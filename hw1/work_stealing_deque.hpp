@@ -0,0 +1,108 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev work-stealing deque of T* (Chase & Lev, SPAA 2005, with the C11 memory orders of
+// Le et al., PPoPP 2013). The owner thread pushes and pops at the bottom, so it keeps running
+// its newest (cache-warm) job; any other thread steals the oldest one from the top.
+// Only pointers are stored, so a thief that loses the race on `top` never touches a job.
+template <class T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256) {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        rings.push_back(std::make_unique<Ring>(cap));
+        ring.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // owner only
+    void push(T* item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Ring* r = ring.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(r->mask)) r = grow(r, t, b);
+        r->put(b, item);
+        // release store rather than fence + relaxed store: same ordering, and visible to TSan
+        bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // owner only; nullptr when empty
+    T* pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {   // empty
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = r->get(b);
+        if (t == b) {  // last one: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                item = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // any thread; nullptr when empty or when another thread took the top job first
+    T* steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        T* item = ring.load(std::memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+    // approximate, for load hints only
+    size_t size() const {
+        int64_t n = bottom.load(std::memory_order_relaxed) - top.load(std::memory_order_relaxed);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+private:
+    struct Ring {
+        explicit Ring(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T*>[capacity]) {}
+
+        T* get(int64_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T* item) { slots[i & mask].store(item, std::memory_order_relaxed); }
+
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    // Double the ring. A thief may still be reading the old one, so old rings are only
+    // freed with the deque.
+    Ring* grow(Ring* old, int64_t t, int64_t b) {
+        rings.push_back(std::make_unique<Ring>(2 * (old->mask + 1)));
+        Ring* r = rings.back().get();
+        for (int64_t i = t; i < b; ++i)
+            r->put(i, old->get(i));
+        ring.store(r, std::memory_order_release);
+        return r;
+    }
+
+    // top and bottom on separate cache lines: thieves hammer one, the owner the other
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Ring*> ring;
+    std::vector<std::unique_ptr<Ring>> rings;   // owner only
+};
+
+#endif
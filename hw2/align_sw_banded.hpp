@@ -0,0 +1,44 @@
+#pragma once
+#include <string>
+#include "align_sw.hpp"  // Reuse AlignmentResult, AlignmentScore and ScoringParams
+
+// Seed-and-extend restriction of the DP matrix. Only cells with |(j - i) - diagonal| <= width
+// are filled (i indexes seq1, j seq2) and no path leaves that band. With xdrop >= 0 the fill
+// also stops after the first row whose best cell falls more than xdrop below the best so far.
+struct BandParams {
+    int diagonal = 0;   // expected seq2 position minus seq1 position
+    int width = 16;     // < 0: no band, the whole matrix
+    int xdrop = -1;     // < 0: no early termination
+};
+
+// O(width * m) time; the traceback keeps 2 or 4 bits per band cell
+AlignmentResult smith_waterman_banded(
+    const std::string& seq1,
+    const std::string& seq2,
+    const BandParams& band,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Score and end cell only, one band row of memory
+AlignmentScore smith_waterman_banded_score(
+    const std::string& seq1,
+    const std::string& seq2,
+    const BandParams& band,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Vectorised across the band. A reverse pass finds the start and the scalar banded traceback
+// runs only inside the box between start and end, so the result is smith_waterman_banded's.
+AlignmentResult smith_waterman_banded_simd(
+    const std::string& seq1,
+    const std::string& seq2,
+    const BandParams& band,
+    const ScoringParams& params = ScoringParams{}
+);
+
+AlignmentScore smith_waterman_banded_simd_score(
+    const std::string& seq1,
+    const std::string& seq2,
+    const BandParams& band,
+    const ScoringParams& params = ScoringParams{}
+);
@@ -0,0 +1,28 @@
+#include "align_sw_batch.hpp"
+#include "align_sw_kernels.hpp"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+std::vector<AlignmentScore> smith_waterman_batch_score(const std::string& query,
+                                                       const std::vector<std::string>& targets,
+                                                       const ScoringParams& params) {
+    std::vector<AlignmentScore> results(targets.size(), AlignmentScore { 0, -1, -1 });
+    if (query.empty() || targets.empty())
+        return results;
+
+    std::vector<uint8_t> q = encode_bases(query);
+    std::vector<std::vector<uint8_t>> codes;
+    codes.reserve(targets.size());
+    for (const std::string& t : targets)
+        codes.push_back(encode_bases(t));
+
+    // Longest first, so each batch of V neighbours has nearly equal lengths and few pad columns
+    std::vector<size_t> order(targets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return targets[a].size() > targets[b].size(); });
+
+    kernels::dispatch(kernels::BatchScan {}, q, codes, std::move(order), params, results);
+    return results;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "align_sw.hpp"  // Reuse AlignmentScore and ScoringParams
+
+// Database scan: one query against many targets, one target per SIMD lane (inter-sequence
+// vectorization). Targets are binned by length so the lanes of a batch finish together.
+// results[t] equals smith_waterman_score(query, targets[t], params):
+// end1 indexes the query, end2 the target.
+std::vector<AlignmentScore> smith_waterman_batch_score(
+    const std::string& query,
+    const std::vector<std::string>& targets,
+    const ScoringParams& params = ScoringParams{}
+);
@@ -0,0 +1,440 @@
+// SIMD kernels, compiled once per instruction set: the makefile builds this file with
+// -DSW_KERNEL_ARCH=<xsimd arch> and the matching -m flags, and align_sw_kernels.hpp picks
+// one of the copies at run time.
+#include "align_sw_striped.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#ifndef SW_KERNEL_ARCH
+#error "align_sw_kernels.cpp must be built with -DSW_KERNEL_ARCH=<xsimd arch>"
+#endif
+
+namespace striped {
+namespace {
+
+// ---- Striped single-pair pass ----
+
+// One band over the whole query with T score lanes. False when T is too narrow: the
+// parameters or the target do not fit, or a lane saturated on the way.
+template <class T, class Arch>
+bool striped_sw_as(const uint8_t* db, size_t m, const QueryProfile& query,
+                   const ScoringParams& p, int target, StripedHit& hit) {
+    const int ceiling = score_ceiling<T>(p);
+    if (!lanes_fit<T>(p) || target >= ceiling)
+        return false;
+    hit = StripedHit {};
+    int band_max = p.is_linear()
+        ? StripedBand<T, false, Arch>(query, 0, query.size(), p).fill(db, m, 0, nullptr, hit, target)
+        : StripedBand<T, true, Arch>(query, 0, query.size(), p).fill(db, m, 0, nullptr, hit, target);
+    return band_max < ceiling;
+}
+
+// ---- Inter-sequence batch scan ----
+
+// Target code for lanes past the end of their target; scores so low that no cell there
+// can reach the real maximum of the lane
+constexpr uint8_t kPadCode = kAlphabetSize;
+
+// One batch of up to V targets, lane l holding targets[lane_ids[l]]. The DP runs column by
+// column over the target positions with the query down the rows, so a column is one
+// vector per query row. Lane columns past a target's end are padding.
+// Targets whose lane saturates T are appended to `wider` instead of getting a result.
+template <class T, bool Affine, class Arch>
+void align_lanes(const std::vector<uint8_t>& query, const std::vector<std::vector<uint8_t>>& targets,
+                 const size_t* lane_ids, size_t lanes, const ScoringParams& p,
+                 std::vector<AlignmentScore>& results, std::vector<size_t>& wider) {
+    using batch = xsimd::batch<T, Arch>;
+    constexpr size_t V = batch::size;
+    const size_t m = query.size();
+    const int ceiling = score_ceiling<T>(p);
+    size_t width = 0;
+    for (size_t l = 0; l < lanes; ++l)
+        width = std::max(width, targets[lane_ids[l]].size());
+
+    // Interleave the target codes: codes[j * V + l] is position j of lane l
+    aligned_vector<T, Arch> codes(width * V, kPadCode);
+    for (size_t l = 0; l < lanes; ++l) {
+        const std::vector<uint8_t>& t = targets[lane_ids[l]];
+        for (size_t j = 0; j < t.size(); ++j)
+            codes[j * V + l] = t[j];
+    }
+
+    // H(i, j-1) and F(i, j-1) (left gap) per query row, one lane per target
+    aligned_vector<T, Arch> col_h(m * V, 0), col_f(Affine ? m * V : 0, p.gap_open);
+    const batch v_open(p.gap_open), v_ext(p.gap_extend), v_zero(0);
+    const batch v_match(p.match), v_mismatch(p.mismatch), v_pad(pad_score<T>());
+
+    // Per lane: best score and its first cell in row-major (query row, target column) order
+    std::vector<int> best(V, 0);
+    std::vector<size_t> best_i(V, 0), best_j(V, 0);
+    std::vector<bool> saturated(V, false);
+    size_t live = lanes;
+
+    for (size_t j = 1; j <= width && live > 0; ++j) {
+        // Column profile: score of each query symbol against this column's target bases
+        batch v_codes = batch::load_aligned(&codes[(j - 1) * V]);
+        batch v_other = xsimd::select(v_codes == batch(kPadCode), v_pad, v_mismatch);
+        batch prof[kAlphabetSize];
+        for (uint8_t c = 0; c < kBaseN; ++c)
+            prof[c] = xsimd::select(v_codes == batch(c), v_match, v_other);
+        prof[kBaseN] = v_other;   // N never matches
+
+        batch v_diag = v_zero, v_e = v_open, v_colmax = v_zero;
+        for (size_t i = 0; i < m; ++i) {
+            batch v_left = batch::load_aligned(&col_h[i * V]);
+            batch v_f = adds(v_left, v_open);
+            if constexpr (Affine) {
+                v_f = xsimd::max(v_f, adds(batch::load_aligned(&col_f[i * V]), v_ext));
+                v_f.store_aligned(&col_f[i * V]);
+            }
+
+            batch v_h = adds(v_diag, prof[query[i]]);
+            v_h = xsimd::max(v_h, v_e);
+            v_h = xsimd::max(v_h, v_f);
+            v_h = xsimd::max(v_h, v_zero);
+            v_h.store_aligned(&col_h[i * V]);
+            v_colmax = xsimd::max(v_colmax, v_h);
+
+            v_e = Affine ? xsimd::max(adds(v_e, v_ext), adds(v_h, v_open)) : adds(v_h, v_open);
+            v_diag = v_left;
+        }
+
+        // Columns come in column-major order, so an equal score only wins with a smaller row.
+        // Rescan the column for lanes that reach their best; that is rare once a lane settles.
+        alignas(64) T colmax[V];
+        v_colmax.store_aligned(colmax);
+        for (size_t l = 0; l < lanes; ++l) {
+            if (saturated[l] || colmax[l] == 0 || colmax[l] < best[l]) continue;
+            if (colmax[l] >= ceiling) {
+                saturated[l] = true;
+                --live;
+                continue;
+            }
+            size_t i = 0;
+            while (col_h[i * V + l] != colmax[l]) ++i;
+            if (colmax[l] > best[l] || i + 1 < best_i[l]) {
+                best[l] = colmax[l];
+                best_i[l] = i + 1;
+                best_j[l] = j;
+            }
+        }
+    }
+
+    for (size_t l = 0; l < lanes; ++l) {
+        if (saturated[l]) {
+            wider.push_back(lane_ids[l]);
+            continue;
+        }
+        results[lane_ids[l]] = AlignmentScore {
+            .score = best[l],
+            .end1 = static_cast<int>(best_i[l]) - 1,
+            .end2 = static_cast<int>(best_j[l]) - 1
+        };
+    }
+}
+
+// Align the targets in `order` with T lanes, V at a time. Returns the ones that need wider lanes.
+template <class T, class Arch>
+std::vector<size_t> align_batches(const std::vector<uint8_t>& query,
+                                  const std::vector<std::vector<uint8_t>>& targets,
+                                  const std::vector<size_t>& order, const ScoringParams& params,
+                                  std::vector<AlignmentScore>& results) {
+    if (!lanes_fit<T>(params))
+        return order;
+    constexpr size_t V = xsimd::batch<T, Arch>::size;
+    std::vector<size_t> wider;
+    for (size_t k = 0; k < order.size(); k += V) {
+        size_t lanes = std::min(V, order.size() - k);
+        if (params.is_linear())
+            align_lanes<T, false, Arch>(query, targets, &order[k], lanes, params, results, wider);
+        else
+            align_lanes<T, true, Arch>(query, targets, &order[k], lanes, params, results, wider);
+    }
+    return wider;
+}
+
+// ---- Tiled wavefront ----
+
+constexpr size_t kTileRows = 256;
+constexpr size_t kMinTileCols = 512;
+constexpr int kTilePolls = 64;   // looks at the row above before a worker sleeps on it
+
+// Tile (r, c) needs the bottom row of (r-1, c), kept in column band c, and the right column
+// of (r, c-1), kept in the worker's LeftBoundary. Each worker claims the next tile row and
+// sweeps it left to right, waiting on the row above, so tile anti-diagonals run in parallel
+// once the pipeline is full. The workers come from WorkerPool::shared(), as in align_pairs.
+template <bool Affine, class Arch>
+StripedHit wavefront(const std::vector<uint8_t>& db, const QueryProfile& query,
+                     const ScoringParams& p, unsigned threads) {
+    size_t m = db.size(), n = query.size();
+    // Several tile columns per worker so the pipeline fill and drain stay short
+    size_t tile_cols = std::max(kMinTileCols, (n + 4 * threads - 1) / (4 * threads));
+    size_t cols = (n + tile_cols - 1) / tile_cols;
+    size_t rows = (m + kTileRows - 1) / kTileRows;
+
+    std::vector<StripedBand<int, Affine, Arch>> bands;
+    bands.reserve(cols);
+    for (size_t c = 0; c < cols; ++c)
+        bands.emplace_back(query, c * tile_cols, std::min(tile_cols, n - c * tile_cols), p);
+
+    // progress[r] = tile columns finished in tile row r
+    std::vector<std::atomic<size_t>> progress(rows);
+    for (auto& done : progress) done.store(0, std::memory_order_relaxed);
+    std::atomic<size_t> next_row{0};
+
+    // A worker ahead of the row above polls it briefly, then sleeps until a tile is finished.
+    // The sleeper count and progress are seq_cst, so either the finishing worker sees the
+    // sleeper or the sleeper sees the progress.
+    std::mutex sleep_mutex;
+    std::condition_variable tile_done;
+    std::atomic<unsigned> sleepers{0};
+    auto wait_tile = [&](size_t r, size_t c) {
+        for (int poll = 0; poll < kTilePolls; ++poll) {
+            if (progress[r].load(std::memory_order_acquire) > c) return;
+            std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        ++sleepers;
+        tile_done.wait(lock, [&] { return progress[r].load() > c; });
+        --sleepers;
+    };
+    auto finish_tile = [&](size_t r, size_t c) {
+        progress[r].store(c + 1);
+        if (sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            tile_done.notify_all();
+        }
+    };
+
+    auto worker = [&](StripedHit& best) {
+        std::vector<int> left_h(kTileRows + 1), left_f(Affine ? kTileRows + 1 : 0);
+        for (size_t r; (r = next_row.fetch_add(1)) < rows;) {
+            size_t row0 = r * kTileRows, height = std::min(kTileRows, m - row0);
+            std::fill(left_h.begin(), left_h.end(), 0);
+            std::fill(left_f.begin(), left_f.end(), kNegInf);
+            LeftBoundary left { left_h.data(), left_f.data() };
+
+            for (size_t c = 0; c < cols; ++c) {
+                if (r > 0) wait_tile(r - 1, c);
+
+                // Tiles are not visited in row-major order, so each tile reports its own first
+                // best cell; starting just below `best` skips the row scans that cannot win.
+                StripedHit tile;
+                tile.score = std::max(best.score - 1, 0);
+                bands[c].fill(&db[row0], height, row0, &left, tile);
+                if (tile.i > 0 && better_hit(tile, best)) best = tile;
+
+                finish_tile(r, c);
+            }
+        }
+    };
+
+    threads = static_cast<unsigned>(std::min<size_t>(threads, rows));
+    std::vector<StripedHit> hits(threads);
+    std::atomic<unsigned> next_hit{0};
+    WorkerPool::shared().run(threads, [&] { worker(hits[next_hit.fetch_add(1)]); });
+
+    StripedHit best;
+    for (const StripedHit& hit : hits)
+        if (hit.i > 0 && better_hit(hit, best)) best = hit;
+    return best;
+}
+
+// ---- Banded pass ----
+
+constexpr uint8_t kBandPad = kAlphabetSize;        // seq2 column outside 1..n
+constexpr uint8_t kBandNoMatch = kAlphabetSize + 1; // seq1 N: equal to no seq2 code
+
+// F along the band row as a log-step prefix max: after the steps S = 1, 2, 4, ..., lane k holds
+// max over k' <= k of f[k'] + (k - k') * extend. `steps[t]` is 2^t * extend. Lanes slid in
+// from below the vector hold `fill`. Exact only for schemes striped::handles() accepts, where reopening
+// a gap never beats extending it.
+template <size_t S, class T, class Arch>
+inline void prefix_gap(xsimd::batch<T, Arch>& f, const xsimd::batch<T, Arch>* steps,
+                       const xsimd::batch<T, Arch>& fill) {
+    if constexpr (S < xsimd::batch<T, Arch>::size) {
+        f = xsimd::max(f, adds(xsimd::slide_left<S * sizeof(T)>(f - fill) + fill, *steps));
+        prefix_gap<2 * S>(f, steps + 1, fill);
+    }
+}
+
+// Rows of the band |(j - i) - diagonal| <= width with T lanes, stored straight across the band
+// rather than striped: cell k of row i is column j = i + lo + k (lo = diagonal - width), so
+// the cell above is k + 1 and the diagonal one k of the previous row, both plain loads.
+// Only F runs along the row, as a prefix scan inside each vector plus a carry between them.
+// Same hit, target and return conventions as StripedBand::fill; without a target the fill
+// also stops after the first row more than band.xdrop below the best.
+template <class T, bool Affine, class Arch>
+int banded_fill(const std::vector<uint8_t>& seq1, const std::vector<uint8_t>& seq2,
+                const BandParams& band, const ScoringParams& p, int target, StripedHit& hit) {
+    using batch = xsimd::batch<T, Arch>;
+    constexpr size_t V = batch::size;
+    const long m = seq1.size(), n = seq2.size();
+    const long lo = band.diagonal - band.width;
+    const size_t cells = 2 * static_cast<size_t>(band.width) + 1;
+    const size_t vecs = (cells + V - 1) / V;
+    const int ceiling = score_ceiling<T>(p);
+
+    // seq2 codes behind `cells` pad codes and followed by a vector row of them, so that every
+    // band row reads whole vectors: column j sits at codes2[cells + j - 1].
+    aligned_vector<T, Arch> codes2(cells + n + vecs * V, kBandPad);
+    for (long j = 0; j < n; ++j)
+        codes2[cells + j] = seq2[j];
+
+    // H and E of the band row, rolled in place. The vector past the last one stays outside
+    // the band, as do the lanes of the last vector past `cells`.
+    aligned_vector<T, Arch> H((vecs + 1) * V, 0), E(Affine ? (vecs + 1) * V : 0, pad_score<T>());
+
+    const batch v_open(p.gap_open), v_ext(p.gap_extend), v_zero(0), v_neg(pad_score<T>());
+    const batch v_match(p.match), v_mismatch(p.mismatch), v_pad(kBandPad);
+    batch steps[8];
+    steps[0] = v_ext;
+    for (size_t t = 1; t < 8; ++t) steps[t] = adds(steps[t - 1], steps[t - 1]);
+
+    alignas(64) T lanes[V];
+    for (size_t l = 0; l < V; ++l) lanes[l] = static_cast<T>(l);
+    const batch v_lanes = batch::load_aligned(lanes);
+    const auto lane0 = v_lanes == v_zero;
+    const auto tail = v_lanes < batch(static_cast<T>(cells - (vecs - 1) * V));
+
+    int band_max = 0;
+    long first = std::max(1L, 1 - lo - 2 * band.width), last = std::min(m, n - lo);
+    for (long i = first; i <= last; ++i) {
+        const long j0 = i + lo;
+        const T* col = &codes2[cells + j0 - 1];
+        uint8_t a = seq1[i - 1];
+        const batch v_a(static_cast<T>(a == kBaseN ? kBandNoMatch : a));
+        batch v_carry = v_neg, v_max = v_zero;
+
+        for (size_t v = 0; v < vecs; ++v) {
+            T* h = &H[v * V];
+            batch v_e = adds(batch::load_unaligned(h + 1), v_open);
+            if constexpr (Affine)
+                v_e = xsimd::max(v_e, adds(batch::load_unaligned(&E[v * V + 1]), v_ext));
+
+            batch v_codes = batch::load_unaligned(col + v * V);
+            auto off_matrix = v_codes == v_pad;
+            batch v_s = xsimd::select(v_codes == v_a, v_match, v_mismatch);
+            v_s = xsimd::select(off_matrix, v_neg, v_s);
+
+            batch v_h = xsimd::max(adds(batch::load_aligned(h), v_s), v_e);
+            v_h = xsimd::max(v_h, v_zero);
+
+            // F(k) = max(H(k-1) + open, F(k-1) + extend). H(k-1) may leave out F(k-1) here:
+            // with gap_open <= gap_extend, F(k-1) + open never beats F(k-1) + extend.
+            batch v_f = xsimd::select(lane0, v_carry, shift_in(adds(v_h, v_open), v_neg));
+            prefix_gap<1>(v_f, steps, v_neg);
+            v_h = xsimd::max(v_h, v_f);
+
+            v_h = xsimd::select(off_matrix, v_zero, v_h);
+            if (v + 1 == vecs) {
+                v_h = xsimd::select(tail, v_h, v_zero);
+                v_e = xsimd::select(tail, v_e, v_neg);
+            }
+            v_h.store_aligned(h);
+            if constexpr (Affine) v_e.store_aligned(&E[v * V]);
+            v_max = xsimd::max(v_max, v_h);
+
+            // F entering the next vector, from this one's last lane
+            v_carry = xsimd::slide_right<(V - 1) * sizeof(T)>(
+                xsimd::max(adds(v_h, v_open), adds(v_f, v_ext)));
+        }
+
+        int row_max = xsimd::reduce_max(v_max);
+        band_max = std::max(band_max, row_max);
+        if (band_max >= ceiling)
+            return band_max;
+
+        if (target < 0) {
+            if (row_max > hit.score) {
+                size_t k = 0;
+                while (H[k] != row_max) ++k;
+                hit = StripedHit { row_max, static_cast<size_t>(i), static_cast<size_t>(j0 + k) };
+            }
+            if (band.xdrop >= 0 && row_max < hit.score - band.xdrop)
+                break;
+        } else if (row_max >= target) {
+            for (size_t k = 0; k < cells; ++k) {
+                if (H[k] != target) continue;
+                hit.score = target;
+                hit.i = i;
+                hit.j = std::max(hit.j, static_cast<size_t>(j0 + k));
+            }
+        }
+    }
+    return band_max;
+}
+
+template <class T, class Arch>
+bool banded_as(const std::vector<uint8_t>& seq1, const std::vector<uint8_t>& seq2,
+               const BandParams& band, const ScoringParams& p, int target, StripedHit& hit) {
+    const int ceiling = score_ceiling<T>(p);
+    if (!lanes_fit<T>(p) || target >= ceiling)
+        return false;
+    hit = StripedHit {};
+    int band_max = p.is_linear()
+        ? banded_fill<T, false, Arch>(seq1, seq2, band, p, target, hit)
+        : banded_fill<T, true, Arch>(seq1, seq2, band, p, target, hit);
+    return band_max < ceiling;
+}
+
+} // namespace
+} // namespace striped
+
+namespace kernels {
+
+using Arch = xsimd::SW_KERNEL_ARCH;
+
+// int8 lanes first (4x the cells per instruction of int32), widening only after saturation
+template <class A>
+StripedHit StripedScan::operator()(A, const uint8_t* db, size_t m, const QueryProfile& query,
+                                   const ScoringParams& p, int target) const {
+    StripedHit hit;
+    if (!striped::striped_sw_as<int8_t, A>(db, m, query, p, target, hit) &&
+        !striped::striped_sw_as<int16_t, A>(db, m, query, p, target, hit))
+        striped::striped_sw_as<int, A>(db, m, query, p, target, hit);
+    return hit;
+}
+
+// int8 lanes first; only the targets whose lanes saturate are re-run wider
+template <class A>
+void BatchScan::operator()(A, const std::vector<uint8_t>& query,
+                           const std::vector<std::vector<uint8_t>>& targets, std::vector<size_t> order,
+                           const ScoringParams& p, std::vector<AlignmentScore>& results) const {
+    order = striped::align_batches<int8_t, A>(query, targets, order, p, results);
+    order = striped::align_batches<int16_t, A>(query, targets, order, p, results);
+    striped::align_batches<int, A>(query, targets, order, p, results);
+}
+
+template <class A>
+StripedHit Wavefront::operator()(A, const std::vector<uint8_t>& db, const QueryProfile& query,
+                                 const ScoringParams& p, unsigned threads) const {
+    return p.is_linear() ? striped::wavefront<false, A>(db, query, p, threads)
+                         : striped::wavefront<true, A>(db, query, p, threads);
+}
+
+template <class A>
+StripedHit BandedScan::operator()(A, const std::vector<uint8_t>& seq1, const std::vector<uint8_t>& seq2,
+                                  const BandParams& band, const ScoringParams& p, int target) const {
+    StripedHit hit;
+    if (!striped::banded_as<int8_t, A>(seq1, seq2, band, p, target, hit) &&
+        !striped::banded_as<int16_t, A>(seq1, seq2, band, p, target, hit))
+        striped::banded_as<int, A>(seq1, seq2, band, p, target, hit);
+    return hit;
+}
+
+template StripedHit StripedScan::operator()<Arch>(Arch, const uint8_t*, size_t, const QueryProfile&,
+                                                  const ScoringParams&, int) const;
+template void BatchScan::operator()<Arch>(Arch, const std::vector<uint8_t>&,
+                                          const std::vector<std::vector<uint8_t>>&, std::vector<size_t>,
+                                          const ScoringParams&, std::vector<AlignmentScore>&) const;
+template StripedHit Wavefront::operator()<Arch>(Arch, const std::vector<uint8_t>&, const QueryProfile&,
+                                                const ScoringParams&, unsigned) const;
+template StripedHit BandedScan::operator()<Arch>(Arch, const std::vector<uint8_t>&, const std::vector<uint8_t>&,
+                                                 const BandParams&, const ScoringParams&, int) const;
+
+} // namespace kernels
@@ -0,0 +1,85 @@
+#pragma once
+// Runtime CPU dispatch for the SIMD kernels. Each kernel is a functor whose operator() is
+// compiled once per instruction set (align_sw_kernels.cpp, built with -DSW_KERNEL_ARCH=<arch>
+// by the makefile) and picked at run time, so one binary runs at full width on every node.
+#include <xsimd/xsimd.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "align_sw.hpp"
+#include "align_sw_banded.hpp"
+#include "seq_encode.hpp"
+
+namespace striped {
+
+struct StripedHit {
+    int score = 0;
+    size_t i = 0, j = 0;   // DP cell (1-based prefix lengths)
+};
+
+// Whether the vector kernels are exact for `p`. They compute F along a column in one sweep
+// (the striped lazy-F loop, the banded prefix scan), which assumes a gap never gains by being
+// closed and reopened, i.e. gap_open <= gap_extend. Engines run the scalar code otherwise.
+inline bool handles(const ScoringParams& p) { return p.gap_open <= p.gap_extend; }
+
+} // namespace striped
+
+namespace kernels {
+
+using striped::StripedHit;
+
+// Widest first: xsimd::dispatch takes the first one the CPU supports
+using simd_archs = xsimd::arch_list<xsimd::avx512bw, xsimd::avx2, xsimd::sse4_1, xsimd::sse2>;
+
+// Striped forward pass over the whole query (see StripedBand::fill for `target`)
+struct StripedScan {
+    template <class Arch>
+    StripedHit operator()(Arch, const uint8_t* db, size_t m, const QueryProfile& query,
+                          const ScoringParams& p, int target) const;
+};
+
+// One target per lane for the targets in `order`, results indexed like `targets`
+struct BatchScan {
+    template <class Arch>
+    void operator()(Arch, const std::vector<uint8_t>& query,
+                    const std::vector<std::vector<uint8_t>>& targets, std::vector<size_t> order,
+                    const ScoringParams& p, std::vector<AlignmentScore>& results) const;
+};
+
+// Tiled multithreaded wavefront over the whole matrix
+struct Wavefront {
+    template <class Arch>
+    StripedHit operator()(Arch, const std::vector<uint8_t>& db, const QueryProfile& query,
+                          const ScoringParams& p, unsigned threads) const;
+};
+
+// Band rows vectorised across the band (StripedBand::fill conventions, plus the row X-drop)
+struct BandedScan {
+    template <class Arch>
+    StripedHit operator()(Arch, const std::vector<uint8_t>& seq1, const std::vector<uint8_t>& seq2,
+                          const BandParams& band, const ScoringParams& p, int target) const;
+};
+
+struct ArchName {
+    template <class Arch>
+    std::string operator()(Arch) const { return Arch::name(); }
+};
+
+// Arch name forced by set_simd_level(), empty for the best one the CPU supports
+const std::string& forced_simd_level();
+
+template <class Kernel, class... Args>
+auto dispatch(Kernel kernel, Args&&... args) {
+    const std::string& level = forced_simd_level();
+    if (level == xsimd::sse2::name())
+        return kernel(xsimd::sse2 {}, std::forward<Args>(args)...);
+    if (level == xsimd::sse4_1::name())
+        return kernel(xsimd::sse4_1 {}, std::forward<Args>(args)...);
+    if (level == xsimd::avx2::name())
+        return kernel(xsimd::avx2 {}, std::forward<Args>(args)...);
+    if (level == xsimd::avx512bw::name())
+        return kernel(xsimd::avx512bw {}, std::forward<Args>(args)...);
+    return xsimd::dispatch<simd_archs>(kernel)(std::forward<Args>(args)...);
+}
+
+} // namespace kernels
@@ -0,0 +1,29 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "align_sw.hpp"  // Reuse AlignmentResult and ScoringParams
+
+// One alignment job: seqs1[first] against seqs2[second]
+struct SequencePair {
+    size_t first, second;
+};
+
+// Every pair of a two-file cross product, or each unordered pair of one file (all-vs-all)
+std::vector<SequencePair> cross_pairs(size_t count1, size_t count2);
+std::vector<SequencePair> all_vs_all_pairs(size_t count);
+
+// Align every pair with smith_waterman_simd on `threads` workers (0 = one per hardware thread),
+// kept in a pool from one call to the next. Workers go through the pairs in input order, each
+// taking the largest m * n among the next 16 * threads pairs not yet emitted, so long pairs
+// start early and the short ones fill the tail, while at most that many results wait for
+// output. Results are handed to `emit(k, result)` in the order of `pairs`, as soon as pair k
+// and all pairs before it are done; `emit` is called under a lock, one pair at a time.
+void align_pairs(
+    const std::vector<std::string>& seqs1,
+    const std::vector<std::string>& seqs2,
+    const std::vector<SequencePair>& pairs,
+    const std::function<void(size_t, const AlignmentResult&)>& emit,
+    const ScoringParams& params = ScoringParams{},
+    unsigned threads = 0
+);
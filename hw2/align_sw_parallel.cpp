@@ -0,0 +1,32 @@
+#include "align_sw_parallel.hpp"
+#include "align_sw_lowmem.hpp"
+#include "align_sw_simd.hpp"
+#include "align_sw_kernels.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+AlignmentScore smith_waterman_parallel_score(const std::string& seq1, const std::string& seq2,
+                                             const ScoringParams& params, unsigned threads) {
+    if (!striped::handles(params))
+        return smith_waterman_score(seq1, seq2, params);
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    striped::StripedHit best;
+    if (!seq1.empty() && !seq2.empty()) {
+        std::vector<uint8_t> db = encode_bases(seq1);
+        QueryProfile query(encode_bases(seq2), params);
+        best = kernels::dispatch(kernels::Wavefront {}, db, query, params, threads);
+    }
+    return AlignmentScore {
+        .score = best.score,
+        .end1 = static_cast<int>(best.i) - 1,
+        .end2 = static_cast<int>(best.j) - 1
+    };
+}
+
+AlignmentResult smith_waterman_parallel(const std::string& seq1, const std::string& seq2,
+                                        const ScoringParams& params, unsigned threads) {
+    return traceback_simd(seq1, seq2, smith_waterman_parallel_score(seq1, seq2, params, threads), params);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include "align_sw.hpp"  // Reuse AlignmentResult and ScoringParams
+
+// Score and end cell via a tiled anti-diagonal wavefront on the CPU. The matrix is cut into
+// tiles that the striped SIMD kernel fills, and tile rows are pipelined across `threads`
+// workers (0 = one per hardware thread) of WorkerPool::shared(). Same score and end cell as
+// smith_waterman.
+AlignmentScore smith_waterman_parallel_score(
+    const std::string& seq1,
+    const std::string& seq2,
+    const ScoringParams& params = ScoringParams{},
+    unsigned threads = 0
+);
+
+// Full alignment: the wavefront score pass, then traceback_simd from its end cell, so the
+// alignment is the one smith_waterman reports (traceback_linear_space gives an O(m + n) one).
+AlignmentResult smith_waterman_parallel(
+    const std::string& seq1,
+    const std::string& seq2,
+    const ScoringParams& params = ScoringParams{},
+    unsigned threads = 0
+);
@@ -1,11 +1,34 @@
 #pragma once
 #include <string>
-#include "align_sw.hpp"  // Reuse AlignmentResult struct
+#include "align_sw.hpp"  // Reuse AlignmentResult and ScoringParams
 
 AlignmentResult smith_waterman_simd(
     const std::string& seq1,
     const std::string& seq2,
-    int match = 2,
-    int mismatch = -1,
-    int gap = -2
+    const ScoringParams& params = ScoringParams{}
 );
+
+// Score and end cell only: the striped forward pass without any traceback.
+AlignmentScore smith_waterman_simd_score(
+    const std::string& seq1,
+    const std::string& seq2,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Full alignment for an end cell that is already known (e.g. from the wavefront score pass):
+// a striped reverse pass bounds the start and the scalar traceback runs inside that box, so the
+// alignment is the one smith_waterman reports.
+AlignmentResult traceback_simd(
+    const std::string& seq1,
+    const std::string& seq2,
+    const AlignmentScore& best,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Instruction set of the SIMD kernels (striped, batch and wavefront): "auto", the default,
+// takes the widest one this CPU supports; "sse2", "sse4.1", "avx2" or "avx512bw" force one.
+// Returns false for an unknown name or one the CPU cannot run.
+bool set_simd_level(const std::string& level);
+
+// Name of the instruction set the kernels currently run with
+std::string simd_level();
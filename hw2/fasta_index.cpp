@@ -0,0 +1,185 @@
+#include "fasta_index.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <filesystem>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+IndexedFasta::IndexedFasta(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + filename);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0) size = st.st_size;
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("cannot map " + filename);
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    close(fd);
+
+    std::string fai_path = filename + ".fai";
+    std::error_code ec;
+    bool fresh = std::filesystem::exists(fai_path, ec)
+        && std::filesystem::last_write_time(fai_path, ec) >= std::filesystem::last_write_time(filename, ec)
+        && !ec;
+    if (!fresh || !load_index(fai_path)) {
+        try {
+            build_index();
+        } catch (...) {
+            if (data) munmap(const_cast<char*>(data), size);
+            throw;
+        }
+        save_index(fai_path);
+    }
+
+    // From here on access is by region, so read-ahead only wastes I/O
+    if (data) madvise(const_cast<char*>(data), size, MADV_RANDOM);
+
+    for (size_t k = 0; k < index.size(); ++k)
+        by_name.emplace(index[k].name, k);
+}
+
+IndexedFasta::~IndexedFasta() {
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+// Same rules as samtools faidx: every line of a sequence but the last has the same length
+void IndexedFasta::build_index() {
+    index.clear();
+    bool short_line = false;   // a shorter line was seen, so the sequence must end here
+
+    for (size_t pos = 0; pos < size;) {
+        const char* line = data + pos;
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', size - pos));
+        size_t width = nl ? nl - line + 1 : size - pos;
+        size_t bases = nl ? nl - line : width;
+        if (bases > 0 && line[bases - 1] == '\r') --bases;
+        pos += width;
+
+        if (bases > 0 && line[0] == '>') {
+            std::string_view header(line + 1, bases - 1);
+            FaiEntry e;
+            e.name = std::string(header.substr(0, header.find_first_of(" \t")));
+            e.offset = pos;
+            index.push_back(std::move(e));
+            short_line = false;
+            continue;
+        }
+        if (index.empty()) {
+            if (bases > 0) throw std::runtime_error("not a FASTA file (no header before sequence)");
+            continue;
+        }
+
+        FaiEntry& e = index.back();
+        if (bases == 0) {
+            short_line = true;
+            continue;
+        }
+        if (short_line)
+            throw std::runtime_error("different line length in sequence '" + e.name + "'");
+        if (e.line_bases == 0) {
+            e.line_bases = bases;
+            e.line_width = width;
+        } else if (bases > e.line_bases) {
+            throw std::runtime_error("different line length in sequence '" + e.name + "'");
+        }
+        if (bases < e.line_bases || width != e.line_width) short_line = true;
+        e.length += bases;
+    }
+}
+
+bool IndexedFasta::load_index(const std::string& fai_path) {
+    std::ifstream file(fai_path);
+    std::string line;
+    index.clear();
+
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        FaiEntry e;
+        if (!std::getline(fields, e.name, '\t')
+            || !(fields >> e.length >> e.offset >> e.line_bases >> e.line_width))
+            return false;
+        // A stale or foreign index must not send fetch() outside the mapping
+        if (e.offset > size || (e.length > 0 && (e.line_bases == 0 || e.line_width < e.line_bases)))
+            return false;
+        index.push_back(std::move(e));
+    }
+    return true;
+}
+
+void IndexedFasta::save_index(const std::string& fai_path) const {
+    std::ofstream file(fai_path);
+    for (const FaiEntry& e : index)
+        file << e.name << '\t' << e.length << '\t' << e.offset << '\t'
+             << e.line_bases << '\t' << e.line_width << '\n';
+}
+
+const FaiEntry& IndexedFasta::entry(const std::string& name) const {
+    auto it = by_name.find(name);
+    if (it == by_name.end()) throw std::runtime_error("sequence '" + name + "' not in index");
+    return index[it->second];
+}
+
+FastaRegion IndexedFasta::resolve(const std::string& region) const {
+    // A whole-sequence name wins, so names that contain ':' still work
+    if (by_name.count(region))
+        return FastaRegion { region, 0, entry(region).length };
+
+    size_t colon = region.rfind(':');
+    if (colon == std::string::npos)
+        throw std::runtime_error("sequence '" + region + "' not in index");
+
+    FastaRegion r { region.substr(0, colon), 0, 0 };
+    uint64_t length = entry(r.name).length;
+
+    std::string range = region.substr(colon + 1);
+    range.erase(std::remove(range.begin(), range.end(), ','), range.end());
+    size_t dash = range.find('-');
+    try {
+        size_t used;
+        uint64_t first = std::stoull(range.substr(0, dash), &used);
+        if (first == 0 || used != std::min(dash, range.size())) throw std::invalid_argument(range);
+        uint64_t last = length;
+        if (dash != std::string::npos) {
+            last = std::stoull(range.substr(dash + 1), &used);
+            if (used != range.size() - dash - 1) throw std::invalid_argument(range);
+        }
+        r.start = std::min(first - 1, length);
+        r.end = std::max(r.start, std::min(last, length));
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("bad region '" + region + "'");
+    }
+    return r;
+}
+
+std::string IndexedFasta::fetch(const FastaRegion& region) const {
+    const FaiEntry& e = entry(region.name);
+    uint64_t start = std::min(region.start, e.length);
+    uint64_t end = std::min(region.end, e.length);
+    if (start >= end) return std::string();
+
+    // Base k lives at offset + (k / line_bases) * line_width + k % line_bases
+    auto byte_of = [&](uint64_t k) { return e.offset + (k / e.line_bases) * e.line_width + k % e.line_bases; };
+    if (byte_of(end - 1) >= size)
+        throw std::runtime_error("index does not match file for sequence '" + e.name + "'");
+
+    std::string seq(end - start, '\0');
+    char* out = seq.data();
+    for (uint64_t k = start; k < end;) {
+        uint64_t n = std::min(e.line_bases - k % e.line_bases, end - k);
+        std::memcpy(out, data + byte_of(k), n);
+        out += n;
+        k += n;
+    }
+    return seq;
+}
@@ -1,16 +1,123 @@
 #include "fasta_parser.hpp"
-#include <fstream>
-#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
 
-std::string read_fasta_sequence(const std::string& filename) {
-    std::ifstream file(filename);
-    std::string line, sequence;
+SequenceReader::SequenceReader(const std::string& filename, size_t chunk_size)
+    : file(filename, std::ios::binary), buf(chunk_size > 0 ? chunk_size : 1) {}
+
+// Move the pending bytes to the front of the buffer (doubling it if they fill it) and
+// append the next chunk of the file.
+void SequenceReader::refill() {
+    if (begin > 0) {
+        std::memmove(buf.data(), buf.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buf.size()) buf.resize(buf.size() * 2);
+
+    file.read(buf.data() + end, buf.size() - end);
+    end += file.gcount();
+    if (!file) eof = true;
+}
+
+// Find the line starting at offset `pos` (relative to `begin`, so offsets survive a refill).
+// `len` excludes the line break, `next` is the offset of the following line.
+bool SequenceReader::read_line(size_t pos, size_t& len, size_t& next) {
+    size_t scanned = pos;
+    for (;;) {
+        const char* line = buf.data() + begin + pos;
+        const char* from = buf.data() + begin + scanned;
+        const void* nl = std::memchr(from, '\n', end - begin - scanned);
+        if (nl) {
+            len = static_cast<const char*>(nl) - line;
+            next = pos + len + 1;
+            break;
+        }
+        scanned = end - begin;
+        if (eof) {
+            if (scanned == pos) return false;
+            len = scanned - pos;   // last line without a line break
+            next = scanned;
+            break;
+        }
+        refill();
+    }
+    if (len > 0 && buf[begin + pos + len - 1] == '\r') --len;
+    return true;
+}
+
+bool SequenceReader::next(SequenceRecord& record) {
+    size_t len, next;
 
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        if (line[0] == '>') continue; // Skip FASTA header
-        sequence += line;
+    // Skip anything before the next header line. Sequence lines at the very top of the file
+    // form a record of their own, without a header, as in a bare sequence file.
+    bool headerless = false;
+    for (;;) {
+        if (!read_line(0, len, next)) return false;
+        char c = buf[begin];
+        if (len > 0 && (c == '>' || c == '@')) break;
+        if (len > 0 && !started) {
+            headerless = true;
+            break;
+        }
+        begin += next;
     }
+    started = true;
+    bool fastq = !headerless && buf[begin] == '@';
+    size_t header_len = headerless ? 0 : len;
+
+    // Sequence (and quality) lines are copied down over the line breaks before them;
+    // `w` is the write offset, always at or behind the read offset `pos`.
+    size_t first = headerless ? 0 : next;
+    size_t seq_begin = first, qual_begin = 0, w = first, pos = first;
+    bool in_qual = false, complete = !fastq;
+    while (read_line(pos, len, next)) {
+        char* line = buf.data() + begin + pos;
+        if (!in_qual && len > 0 && line[0] == (fastq ? '+' : '>')) {
+            if (!fastq) break;
+            in_qual = true;
+            qual_begin = w;
+            pos = next;
+            continue;
+        }
+        std::memmove(buf.data() + begin + w, line, len);
+        w += len;
+        pos = next;
+        if (in_qual && w - qual_begin >= qual_begin - seq_begin) {
+            complete = true;
+            break;
+        }
+    }
+    if (!complete)
+        throw std::runtime_error("truncated FASTQ record");
+
+    const char* base = buf.data() + begin;
+    std::string_view header = headerless ? std::string_view() : std::string_view(base + 1, header_len - 1);
+    size_t name_end = std::min(header.find_first_of(" \t"), header.size());
+    size_t comment_begin = std::min(header.find_first_not_of(" \t", name_end), header.size());
+    record.name = header.substr(0, name_end);
+    record.comment = header.substr(comment_begin);
+    record.seq = std::string_view(base + seq_begin, (in_qual ? qual_begin : w) - seq_begin);
+    record.qual = in_qual ? std::string_view(base + qual_begin, w - qual_begin) : std::string_view();
+
+    begin += pos;
+    return true;
+}
+
+std::string read_fasta_sequence(const std::string& filename) {
+    SequenceReader reader(filename);
+    if (!reader.is_open()) throw std::runtime_error("cannot open " + filename);
+    SequenceRecord record;
+    std::string sequence;
+
+    // The joined sequence is never longer than the file, so one allocation is enough
+    std::error_code ec;
+    auto size = std::filesystem::file_size(filename, ec);
+    if (!ec) sequence.reserve(size);
+
+    while (reader.next(record)) sequence += record.seq;
 
     return sequence;
 }
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "align_sw.hpp"  // ScoringParams
+
+// Nucleotide codes used by every aligner: A C G T (either case) = 0..3, anything else
+// (N, IUPAC ambiguity codes, stray characters) = kBaseN. N never counts as a match,
+// not even against another N.
+constexpr uint8_t kBaseN = 4;
+constexpr size_t kAlphabetSize = 5;
+
+// Scalar lookup table, for the places that look at one base at a time
+extern const std::array<uint8_t, 256> kBaseCode;
+
+inline uint8_t encode_base(char c) { return kBaseCode[static_cast<unsigned char>(c)]; }
+inline bool bases_match(uint8_t a, uint8_t b) { return a == b && a != kBaseN; }
+
+// Whole-sequence translation, vectorised with xsimd
+std::vector<uint8_t> encode_bases(const std::string& seq);
+
+// Per-symbol query profile: row(c)[j] is the substitution score of code c against query[j].
+// Built once per alignment so the DP inner loop is a load instead of a compare.
+class QueryProfile {
+public:
+    QueryProfile(const std::vector<uint8_t>& query, const ScoringParams& params);
+
+    const int* row(uint8_t code) const { return &scores[code * length]; }
+    size_t size() const { return length; }
+
+private:
+    size_t length;
+    std::vector<int> scores;   // kAlphabetSize rows of `length`
+};
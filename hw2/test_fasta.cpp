@@ -0,0 +1,251 @@
+#include "fasta_parser.hpp"
+#include "fasta_index.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Checks of the .fai index and the streaming reader on generated files.
+//   make check
+
+namespace fs = std::filesystem;
+
+// Scratch directory for the generated files, removed at exit
+struct TempDir {
+    fs::path path = fs::temp_directory_path() / ("test_fasta." + std::to_string(getpid()));
+    TempDir() { fs::create_directories(path); }
+    ~TempDir() { fs::remove_all(path); }
+    std::string file(const std::string& name) const { return (path / name).string(); }
+};
+
+void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path, std::ios::binary) << text;
+}
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+template <typename F>
+bool throws(F&& f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// One record of the generated FASTA and the .fai line samtools faidx writes for it
+struct Generated {
+    std::string name, seq;
+    std::string fai;
+};
+
+// Records of different line widths, one with CRLF line breaks, a short last line and an
+// empty sequence. The expected .fai line is worked out while writing each record.
+std::vector<Generated> write_fasta(const std::string& path) {
+    struct Layout { const char* name; size_t length, line_bases; bool crlf; };
+    const Layout layouts[] = {
+        {"chr1", 1000, 60, false},
+        {"chr2", 120, 60, false},     // whole lines only
+        {"crlf", 333, 50, true},
+        {"empty", 0, 0, false},
+        {"one", 7, 80, false},
+    };
+    std::mt19937 rng(8);
+    std::string text;
+    std::vector<Generated> records;
+    for (const Layout& l : layouts) {
+        Generated g {l.name, "", ""};
+        for (size_t k = 0; k < l.length; ++k) g.seq += "ACGTN"[rng() % 5];
+        const char* eol = l.crlf ? "\r\n" : "\n";
+        text += ">" + g.name + " generated record" + eol;
+        size_t offset = text.size();
+        for (size_t k = 0; k < l.length; k += l.line_bases)
+            text += g.seq.substr(k, l.line_bases) + eol;
+        // a sequence shorter than one line gets the width of its only line
+        size_t bases = std::min(l.line_bases, l.length), width = bases ? bases + (l.crlf ? 2 : 1) : 0;
+        g.fai = g.name + "\t" + std::to_string(l.length) + "\t" + std::to_string(offset) + "\t"
+              + std::to_string(bases) + "\t" + std::to_string(width) + "\n";
+        records.push_back(g);
+    }
+    write_file(path, text);
+    return records;
+}
+
+// The built index, the .fai written next to the FASTA (field for field samtools' format),
+// and the same index read back from that .fai
+void test_index(const TempDir& dir) {
+    std::string path = dir.file("genome.fa");
+    std::vector<Generated> records = write_fasta(path);
+    std::string want_fai;
+    for (const Generated& g : records) want_fai += g.fai;
+
+    std::vector<FaiEntry> built;
+    {
+        IndexedFasta fasta(path);
+        built = fasta.entries();
+        assert(built.size() == records.size());
+    }
+    assert(read_file(path + ".fai") == want_fai && "the .fai differs from samtools faidx");
+
+    // The index is now loaded from the .fai rather than rebuilt
+    IndexedFasta loaded(path);
+    assert(loaded.entries().size() == built.size());
+    for (size_t k = 0; k < built.size(); ++k) {
+        const FaiEntry& a = built[k];
+        const FaiEntry& b = loaded.entries()[k];
+        assert(a.name == b.name && a.length == b.length && a.offset == b.offset
+               && a.line_bases == b.line_bases && a.line_width == b.line_width && "the .fai round trip changed an entry");
+    }
+
+    // A .fai older than the FASTA is rebuilt, not trusted
+    write_file(path + ".fai", "chr1\t5\t0\t5\t6\n");
+    fs::last_write_time(path + ".fai", fs::last_write_time(path) - std::chrono::hours(1));
+    IndexedFasta rebuilt(path);
+    assert(rebuilt.entry("chr1").length == 1000 && "a stale .fai was used");
+    assert(read_file(path + ".fai") == want_fai);
+
+    std::cout << "fai index: OK" << std::endl;
+}
+
+// Region syntax, clipping and fetches across line breaks (CRLF included)
+void test_regions(const TempDir& dir) {
+    std::string path = dir.file("regions.fa");
+    std::vector<Generated> records = write_fasta(path);
+    IndexedFasta fasta(path);
+
+    auto same = [](const FastaRegion& r, const std::string& name, uint64_t start, uint64_t end) {
+        return r.name == name && r.start == start && r.end == end;
+    };
+    assert(same(fasta.resolve("chr1"), "chr1", 0, 1000));
+    assert(same(fasta.resolve("chr1:101"), "chr1", 100, 1000));
+    assert(same(fasta.resolve("chr1:11-20"), "chr1", 10, 20));
+    assert(same(fasta.resolve("chr1:1,0-1,00"), "chr1", 9, 100) && "commas are allowed in positions");
+    assert(same(fasta.resolve("chr2:100-5000"), "chr2", 99, 120) && "the end is clipped to the sequence");
+    assert(same(fasta.resolve("chr2:500-600"), "chr2", 120, 120) && "a region past the end is empty");
+    assert(same(fasta.resolve("chr2:30-20"), "chr2", 29, 29));
+
+    for (const char* bad : {"nosuch", "nosuch:1-5", "chr1:0-5", "chr1:x-5", "chr1:5-y", "chr1:5-", "chr1:-5", "chr1:"})
+        assert(throws([&] { fasta.resolve(bad); }) && "a bad region was accepted");
+
+    std::mt19937 rng(9);
+    for (const Generated& g : records) {
+        assert(fasta.fetch(g.name) == g.seq);
+        for (int k = 0; k < 50 && !g.seq.empty(); ++k) {
+            uint64_t start = rng() % g.seq.size(), end = start + rng() % (g.seq.size() - start + 1);
+            std::string got = fasta.fetch(FastaRegion {g.name, start, end});
+            assert(got == g.seq.substr(start, end - start) && "fetch returned the wrong bases");
+        }
+    }
+    assert(fasta.fetch("chr1:991-2000") == records[0].seq.substr(990));
+    assert(fasta.fetch("crlf:50-51") == records[2].seq.substr(49, 2) && "a fetch across a CRLF break");
+    std::cout << "regions: OK" << std::endl;
+}
+
+// Files samtools faidx refuses are refused here too
+void test_bad_fasta(const TempDir& dir) {
+    std::string path = dir.file("bad.fa");
+    write_file(path, "ACGT\n>x\nACGT\n");
+    assert(throws([&] { IndexedFasta fasta(path); }) && "sequence before the first header");
+    write_file(path, ">x\nACGT\nACGTAC\nAC\n");
+    assert(throws([&] { IndexedFasta fasta(path); }) && "a longer line after a shorter one");
+    write_file(path, ">x\nACGT\nAC\nAC\n");
+    assert(throws([&] { IndexedFasta fasta(path); }) && "a short line inside the sequence");
+    assert(throws([&] { IndexedFasta fasta(dir.file("missing.fa")); }));
+    std::cout << "bad FASTA: OK" << std::endl;
+}
+
+struct Expected {
+    std::string name, comment, seq, qual;
+};
+
+// Every record of `path` at the given chunk size
+std::vector<Expected> read_all(const std::string& path, size_t chunk_size) {
+    SequenceReader reader(path, chunk_size);
+    assert(reader.is_open());
+    std::vector<Expected> got;
+    SequenceRecord r;
+    while (reader.next(r))
+        got.push_back({std::string(r.name), std::string(r.comment), std::string(r.seq), std::string(r.qual)});
+    return got;
+}
+
+// Mixed multi-line FASTA/FASTQ with CRLF, quality lines that start with '@' or '+', at chunk
+// sizes down to one byte so every record, and most lines, straddle a refill
+void test_reader(const TempDir& dir) {
+    std::string path = dir.file("reads.fq");
+    write_file(path,
+        "@r1 first read\n"
+        "ACGTAC\n"
+        "GTA\n"
+        "+\n"
+        "@@@II\n"            // a quality line starting with '@'
+        "+I#I\n"             // and one starting with '+'
+        "@r2\r\n"
+        "ACGT\r\n"
+        "+r2\r\n"
+        "IIII\r\n"
+        ">f1\tcomment with  spaces\n"
+        "AC\n"
+        "\n"
+        "GT\n"
+        ">f2\n"
+        ">f3 last\r\n"
+        "NNNN");             // no line break at the end
+    const std::vector<Expected> want = {
+        {"r1", "first read", "ACGTACGTA", "@@@II+I#I"},
+        {"r2", "", "ACGT", "IIII"},
+        {"f1", "comment with  spaces", "ACGT", ""},
+        {"f2", "", "", ""},
+        {"f3", "last", "NNNN", ""},
+    };
+    for (size_t chunk : {size_t(1), size_t(2), size_t(5), size_t(13), size_t(1) << 20}) {
+        std::vector<Expected> got = read_all(path, chunk);
+        assert(got.size() == want.size() && "wrong number of records");
+        for (size_t k = 0; k < want.size(); ++k)
+            assert(got[k].name == want[k].name && got[k].comment == want[k].comment && got[k].seq == want[k].seq
+                   && got[k].qual == want[k].qual && "record read wrongly");
+    }
+
+    // Quality shorter than the sequence at end of file
+    write_file(path, "@ok\nAC\n+\nII\n@cut\nACGT\n+\nII\n");
+    for (size_t chunk : {size_t(3), size_t(1) << 20}) {
+        SequenceReader reader(path, chunk);
+        SequenceRecord r;
+        assert(reader.next(r) && r.name == "ok");
+        assert(throws([&] { reader.next(r); }) && "a truncated FASTQ record was accepted");
+    }
+
+    // Bare sequence lines ahead of the first header are one record without a name
+    write_file(path, "\nACGT\r\nAC\n>x\nGG\n");
+    std::vector<Expected> got = read_all(path, 4);
+    assert(got.size() == 2 && got[0].name.empty() && got[0].seq == "ACGTAC" && got[1].seq == "GG");
+    assert(read_fasta_sequence(path) == "ACGTACGG");
+
+    assert(!SequenceReader(dir.file("missing.fq")).is_open());
+    assert(throws([&] { read_fasta_sequence(dir.file("missing.fq")); }));
+    std::cout << "sequence reader: OK" << std::endl;
+}
+
+int main() {
+    TempDir dir;
+    test_index(dir);
+    test_regions(dir);
+    test_bad_fasta(dir);
+    test_reader(dir);
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}
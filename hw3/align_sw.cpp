@@ -1,66 +1,173 @@
 #include "align_sw.hpp"
+#include "seq_encode.hpp"
+#include "align_sw_traceback.hpp"
 #include <vector>
 #include <algorithm>
-#include <sstream>
+#include <limits>
+#include <cstdint>
 
-AlignmentResult smith_waterman(const std::string& seq1, const std::string& seq2,
-                               int match, int mismatch, int gap) {
+namespace {
+
+template <bool Affine>
+AlignmentResult smith_waterman_impl(const std::string& seq1, const std::string& seq2,
+                                    const ScoringParams& p) {
     size_t m = seq1.size(), n = seq2.size();
-    std::vector<std::vector<int>> H(m + 1, std::vector<int>(n + 1, 0));
-    std::vector<std::vector<int>> traceback(m + 1, std::vector<int>(n + 1, 0));
+    std::vector<uint8_t> codes1 = encode_bases(seq1);
+    QueryProfile profile(encode_bases(seq2), p);
+    // Linear gaps only need the H source; affine adds the two extend flags
+    PackedTraceback<Affine ? 4 : 2> traceback(m, n);
+
+    // The traceback never reads H back (a zero cell has its own code), so one rolling row
+    // is enough: H[j] holds row i-1 to the right of j and row i to the left of it.
+    // Gotoh state: E(i-1, j) for the row above, F(i, j-1) for the cell to the left.
+    std::vector<int> H(n + 1, 0);
+    std::vector<int> E(Affine ? n + 1 : 0, kNegInf);
 
     int max_score = 0, max_i = 0, max_j = 0;
 
     // Fill DP table
     for (size_t i = 1; i <= m; ++i) {
+        const int* prof = profile.row(codes1[i - 1]);
+        int diag = 0, F = kNegInf;
         for (size_t j = 1; j <= n; ++j) {
-            int score_diag = H[i - 1][j - 1] + (seq1[i - 1] == seq2[j - 1] ? match : mismatch);
-            int score_up   = H[i - 1][j] + gap;
-            int score_left = H[i][j - 1] + gap;
-            H[i][j] = std::max({0, score_diag, score_up, score_left});
+            int up = H[j];
+            int score_diag = diag + prof[j - 1];
+            int score_up, score_left;
+            uint8_t flags = 0;
+
+            if constexpr (Affine) {
+                int open_up = up + p.gap_open, ext_up = E[j] + p.gap_extend;
+                if (ext_up > open_up) flags |= kExtendUp;
+                E[j] = std::max(open_up, ext_up);
+
+                int open_left = H[j - 1] + p.gap_open, ext_left = F + p.gap_extend;
+                if (ext_left > open_left) flags |= kExtendLeft;
+                F = std::max(open_left, ext_left);
+
+                score_up = E[j];
+                score_left = F;
+            } else {
+                score_up   = up + p.gap_open;
+                score_left = H[j - 1] + p.gap_open;
+            }
 
-            if (H[i][j] == score_diag) traceback[i][j] = 1;
-            else if (H[i][j] == score_up) traceback[i][j] = 2;
-            else if (H[i][j] == score_left) traceback[i][j] = 3;
+            int h = std::max({0, score_diag, score_up, score_left});
+            diag = up;
+            H[j] = h;
 
-            if (H[i][j] > max_score) {
-                max_score = H[i][j];
+            if (h == 0) flags |= kFromZero;
+            else if (h == score_diag) flags |= kFromDiag;
+            else if (h == score_up) flags |= kFromUp;
+            else flags |= kFromLeft;
+            traceback.set(i, j, flags);
+
+            if (h > max_score) {
+                max_score = h;
                 max_i = i;
                 max_j = j;
             }
         }
     }
 
-    // Traceback
-    std::string align1, align2, match_line;
     int i = max_i, j = max_j;
-    int end1 = i, end2 = j;
-
-    while (i > 0 && j > 0 && H[i][j] > 0) {
-        if (traceback[i][j] == 1) {
-            align1 = seq1[i - 1] + align1;
-            align2 = seq2[j - 1] + align2;
-            match_line = (seq1[i - 1] == seq2[j - 1] ? "|" : "*") + match_line;
-            --i; --j;
-        } else if (traceback[i][j] == 2) {
-            align1 = seq1[i - 1] + align1;
-            align2 = "-" + align2;
-            match_line = " " + match_line;
-            --i;
+    std::string ops = walk_traceback<Affine>(
+        [&](int r, int c) { return traceback.get(r, c); }, i, j);
+
+    AlignmentResult result;
+    result.score = max_score;
+    result.start1 = i;
+    result.end1 = max_i - 1;
+    result.start2 = j;
+    result.end2 = max_j - 1;
+    build_cigar(result, ops, seq1, seq2);
+    return result;
+}
+
+} // namespace
+
+AlignmentResult smith_waterman(const std::string& seq1, const std::string& seq2,
+                               const ScoringParams& params) {
+    // Linear gaps need no E/F state, so they get their own instantiation
+    if (params.is_linear())
+        return smith_waterman_impl<false>(seq1, seq2, params);
+    return smith_waterman_impl<true>(seq1, seq2, params);
+}
+
+std::string AlignmentResult::cigar_string(bool extended) const {
+    std::string text;
+    for (size_t k = 0; k < cigar.size(); ++k) {
+        uint32_t len = cigar[k].len;
+        char op = cigar[k].op;
+        if (!extended && (op == '=' || op == 'X')) {
+            op = 'M';
+            while (k + 1 < cigar.size() && (cigar[k + 1].op == '=' || cigar[k + 1].op == 'X'))
+                len += cigar[++k].len;
+        }
+        text += std::to_string(len);
+        text += op;
+    }
+    return text;
+}
+
+AlignmentResult empty_result() {
+    AlignmentResult result;
+    result.score = 0;
+    result.start1 = 0;
+    result.end1 = -1;
+    result.start2 = 0;
+    result.end2 = -1;
+    return result;
+}
+
+void build_cigar(AlignmentResult& result, const std::string& ops,
+                 const std::string& seq1, const std::string& seq2) {
+    result.cigar.clear();
+    result.matches = result.mismatches = result.gaps = 0;
+
+    size_t i = result.start1, j = result.start2;
+    for (char op : ops) {
+        char c;
+        if (op == 'M') {
+            c = bases_match(encode_base(seq1[i++]), encode_base(seq2[j++])) ? '=' : 'X';
+            ++(c == '=' ? result.matches : result.mismatches);
         } else {
-            align1 = "-" + align1;
-            align2 = seq2[j - 1] + align2;
-            match_line = " " + match_line;
-            --j;
+            c = op;
+            ++(op == 'D' ? i : j);
+            ++result.gaps;
         }
+
+        if (!result.cigar.empty() && result.cigar.back().op == c)
+            ++result.cigar.back().len;
+        else
+            result.cigar.push_back(CigarOp { 1, c });
     }
+}
+
+AlignedStrings render_alignment(const AlignmentResult& result,
+                                const std::string& seq1, const std::string& seq2) {
+    size_t columns = result.matches + result.mismatches + result.gaps;
+    AlignedStrings out;
+    out.seq1.reserve(columns);
+    out.seq2.reserve(columns);
+    out.match_line.reserve(columns);
 
-    return AlignmentResult {
-        .score = max_score,
-        .start1 = i, .end1 = end1 - 1,
-        .start2 = j, .end2 = end2 - 1,
-        .aligned_seq1 = align1,
-        .aligned_seq2 = align2,
-        .match_line = match_line
-    };
+    size_t i = result.start1, j = result.start2;
+    for (const CigarOp& run : result.cigar) {
+        for (uint32_t k = 0; k < run.len; ++k) {
+            if (run.op == '=' || run.op == 'X') {
+                out.seq1 += seq1[i++];
+                out.seq2 += seq2[j++];
+                out.match_line += run.op == '=' ? '|' : '*';
+            } else if (run.op == 'D') {
+                out.seq1 += seq1[i++];
+                out.seq2 += '-';
+                out.match_line += ' ';
+            } else {
+                out.seq1 += '-';
+                out.seq2 += seq2[j++];
+                out.match_line += ' ';
+            }
+        }
+    }
+    return out;
 }
@@ -1,19 +1,68 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
+
+// Scoring scheme shared by every aligner. A gap of length L costs
+// gap_open + (L - 1) * gap_extend, so gap_open == gap_extend is the linear model.
+struct ScoringParams {
+    int match = 2;
+    int mismatch = -1;
+    int gap_open = -2;
+    int gap_extend = -2;
+
+    bool is_linear() const { return gap_open == gap_extend; }
+};
+
+// One CIGAR run: `len` columns of `op`. seq1 is the reference and seq2 the query, so
+// '=' match, 'X' mismatch, 'D' seq1 char against a gap, 'I' gap against a seq2 char.
+struct CigarOp {
+    uint32_t len;
+    char op;
+};
 
 struct AlignmentResult {
     int score;
     int start1, end1;
     int start2, end2;
-    std::string aligned_seq1;
-    std::string aligned_seq2;
+    std::vector<CigarOp> cigar;
+    int matches = 0, mismatches = 0, gaps = 0;   // columns of each kind
+
+    // Fraction of alignment columns that are matches (BLAST-style identity)
+    double identity() const {
+        int columns = matches + mismatches + gaps;
+        return columns ? static_cast<double>(matches) / columns : 0.0;
+    }
+    // Extended CIGAR text, e.g. "12=1X3=2I5="; with extended == false runs of =/X merge into M
+    std::string cigar_string(bool extended = true) const;
+};
+
+// Gapped display strings, built from the CIGAR only when something is printed
+struct AlignedStrings {
+    std::string seq1;
+    std::string seq2;
     std::string match_line;
 };
 
+// Score-only result; end1/end2 are 0-based inclusive like AlignmentResult (-1 when score is 0)
+struct AlignmentScore {
+    int score;
+    int end1, end2;
+};
+
 AlignmentResult smith_waterman(
     const std::string& seq1,
     const std::string& seq2,
-    int match = 2,
-    int mismatch = -1,
-    int gap = -2
+    const ScoringParams& params = ScoringParams{}
 );
+
+// Result for a score of 0: no aligned columns, end1 = end2 = -1
+AlignmentResult empty_result();
+
+// Fill result.cigar and the column counters from an edit script ('M', 'D', 'I' per column)
+// starting at result.start1 / result.start2
+void build_cigar(AlignmentResult& result, const std::string& ops,
+                 const std::string& seq1, const std::string& seq2);
+
+AlignedStrings render_alignment(const AlignmentResult& result,
+                                const std::string& seq1, const std::string& seq2);
@@ -0,0 +1,227 @@
+#include "align_sw_banded.hpp"
+#include "align_sw_kernels.hpp"
+#include "align_sw_traceback.hpp"
+#include "seq_encode.hpp"
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+// The band cut down to the diagonals 1 - m .. n - 1 that the m x n matrix has (all of them for
+// width < 0), so a row never holds more cells than the matrix is wide, whatever width and
+// diagonal the caller asks for. The cells filled are the same.
+BandParams cover(const BandParams& band, size_t m, size_t n) {
+    const long first = 1 - static_cast<long>(m), last = static_cast<long>(n) - 1;
+    long lo = first, hi = last;
+    if (band.width >= 0) {
+        lo = std::max(lo, static_cast<long>(band.diagonal) - band.width);
+        hi = std::min(hi, static_cast<long>(band.diagonal) + band.width);
+    }
+    // a band beside the matrix: the single diagonal n, which has no cells
+    if (lo > hi)
+        return BandParams { .diagonal = static_cast<int>(last + 1), .width = 0, .xdrop = band.xdrop };
+    // an odd number of diagonals takes one more on a side that was cut at the matrix edge
+    if ((hi - lo) % 2 != 0) {
+        if (lo == first) --lo;
+        else ++hi;
+    }
+    return BandParams {
+        .diagonal = static_cast<int>((lo + hi) / 2),
+        .width = static_cast<int>((hi - lo) / 2),
+        .xdrop = band.xdrop
+    };
+}
+
+// One row of the band at a time: cell k of row i is column j = i + lo + k, lo = diagonal - width.
+// The cell above (i-1, j) is k + 1 of the previous row and the diagonal one is k, so H and E
+// roll in place. Cells off the matrix hold H = 0 and no gap state.
+// With a traceback, the code of cell (i, j) goes to (i, k + 1).
+template <bool Affine, class Traceback>
+AlignmentScore banded_fill(const std::vector<uint8_t>& codes1, const QueryProfile& profile,
+                           const BandParams& band, const ScoringParams& p, Traceback* traceback) {
+    const long m = codes1.size(), n = profile.size();
+    const long lo = band.diagonal - band.width;
+    const size_t cells = 2 * static_cast<size_t>(band.width) + 1;
+    // H[cells] / E[cells] is the cell above the right edge, outside the band
+    std::vector<int> H(cells + 1, 0);
+    std::vector<int> E(Affine ? cells + 1 : 0, kNegInf);
+
+    int max_score = 0;
+    long max_i = 0, max_j = 0;
+
+    // Rows whose band meets columns 1..n
+    long first = std::max(1L, 1 - lo - 2 * band.width), last = std::min(m, n - lo);
+    for (long i = first; i <= last; ++i) {
+        const int* prof = profile.row(codes1[i - 1]);
+        long j0 = i + lo;
+        int left = 0, F = kNegInf;
+        int row_max = 0;
+        long row_j = 0;
+
+        for (size_t k = 0; k < cells; ++k) {
+            long j = j0 + static_cast<long>(k);
+            int diag = H[k], up = H[k + 1];
+            if (j < 1 || j > n) {
+                H[k] = left = 0;
+                if constexpr (Affine) E[k] = kNegInf;
+                F = kNegInf;
+                continue;
+            }
+
+            int score_diag = diag + prof[j - 1];
+            int score_up, score_left;
+            uint8_t flags = 0;
+
+            if constexpr (Affine) {
+                int open_up = up + p.gap_open, ext_up = E[k + 1] + p.gap_extend;
+                if (ext_up > open_up) flags |= kExtendUp;
+                E[k] = std::max(open_up, ext_up);
+
+                int open_left = left + p.gap_open, ext_left = F + p.gap_extend;
+                if (ext_left > open_left) flags |= kExtendLeft;
+                F = std::max(open_left, ext_left);
+
+                score_up = E[k];
+                score_left = F;
+            } else {
+                score_up   = up + p.gap_open;
+                score_left = left + p.gap_open;
+            }
+
+            int h = std::max({0, score_diag, score_up, score_left});
+            H[k] = left = h;
+
+            if (traceback) {
+                if (h == 0) flags |= kFromZero;
+                else if (h == score_diag) flags |= kFromDiag;
+                else if (h == score_up) flags |= kFromUp;
+                else flags |= kFromLeft;
+                traceback->set(i, k + 1, flags);
+            }
+
+            if (h > row_max) {
+                row_max = h;
+                row_j = j;
+            }
+        }
+
+        if (row_max > max_score) {
+            max_score = row_max;
+            max_i = i;
+            max_j = row_j;
+        }
+        // X-drop: this row is too far below the best for the extension to recover
+        if (band.xdrop >= 0 && row_max < max_score - band.xdrop)
+            break;
+    }
+
+    return AlignmentScore {
+        .score = max_score,
+        .end1 = static_cast<int>(max_i) - 1,
+        .end2 = static_cast<int>(max_j) - 1
+    };
+}
+
+template <bool Affine>
+AlignmentResult smith_waterman_banded_impl(const std::string& seq1, const std::string& seq2,
+                                           const BandParams& band, const ScoringParams& p) {
+    std::vector<uint8_t> codes1 = encode_bases(seq1);
+    QueryProfile profile(encode_bases(seq2), p);
+    const long lo = band.diagonal - band.width;
+    PackedTraceback<Affine ? 4 : 2> traceback(seq1.size(), 2 * static_cast<size_t>(band.width) + 1);
+
+    AlignmentScore best = banded_fill<Affine>(codes1, profile, band, p, &traceback);
+
+    int i = best.end1 + 1, j = best.end2 + 1;
+    std::string ops = walk_traceback<Affine>(
+        [&](int r, int c) { return traceback.get(r, c - (r + lo) + 1); }, i, j);
+
+    AlignmentResult result;
+    result.score = best.score;
+    result.start1 = i;
+    result.end1 = best.end1;
+    result.start2 = j;
+    result.end2 = best.end2;
+    build_cigar(result, ops, seq1, seq2);
+    return result;
+}
+
+} // namespace
+
+AlignmentResult smith_waterman_banded(const std::string& seq1, const std::string& seq2,
+                                      const BandParams& band, const ScoringParams& params) {
+    BandParams b = cover(band, seq1.size(), seq2.size());
+    if (params.is_linear())
+        return smith_waterman_banded_impl<false>(seq1, seq2, b, params);
+    return smith_waterman_banded_impl<true>(seq1, seq2, b, params);
+}
+
+AlignmentScore smith_waterman_banded_score(const std::string& seq1, const std::string& seq2,
+                                           const BandParams& band, const ScoringParams& params) {
+    BandParams b = cover(band, seq1.size(), seq2.size());
+    std::vector<uint8_t> codes1 = encode_bases(seq1);
+    QueryProfile profile(encode_bases(seq2), params);
+    PackedTraceback<2>* none = nullptr;
+    if (params.is_linear())
+        return banded_fill<false>(codes1, profile, b, params, none);
+    return banded_fill<true>(codes1, profile, b, params, none);
+}
+
+AlignmentScore smith_waterman_banded_simd_score(const std::string& seq1, const std::string& seq2,
+                                                const BandParams& band, const ScoringParams& params) {
+    if (!striped::handles(params))
+        return smith_waterman_banded_score(seq1, seq2, band, params);
+
+    BandParams b = cover(band, seq1.size(), seq2.size());
+    striped::StripedHit best;
+    if (!seq1.empty() && !seq2.empty())
+        best = kernels::dispatch(kernels::BandedScan {}, encode_bases(seq1), encode_bases(seq2),
+                                 b, params, -1);
+    return AlignmentScore {
+        .score = best.score,
+        .end1 = static_cast<int>(best.i) - 1,
+        .end2 = static_cast<int>(best.j) - 1
+    };
+}
+
+AlignmentResult smith_waterman_banded_simd(const std::string& seq1, const std::string& seq2,
+                                           const BandParams& band, const ScoringParams& params) {
+    if (!striped::handles(params))
+        return smith_waterman_banded(seq1, seq2, band, params);
+
+    size_t m = seq1.size(), n = seq2.size();
+    BandParams b = cover(band, m, n);
+    std::vector<uint8_t> codes1 = encode_bases(seq1), codes2 = encode_bases(seq2);
+
+    striped::StripedHit best;
+    if (m > 0 && n > 0)
+        best = kernels::dispatch(kernels::BandedScan {}, codes1, codes2, b, params, -1);
+
+    if (best.score == 0)
+        return empty_result();
+
+    // Reverse pass over the prefixes ending at the best cell, as in smith_waterman_simd.
+    // Reversing both prefixes maps diagonal d to (best.j - best.i) - d.
+    std::vector<uint8_t> rev1(codes1.rbegin() + (m - best.i), codes1.rend());
+    std::vector<uint8_t> rev2(codes2.rbegin() + (n - best.j), codes2.rend());
+    BandParams reverse {
+        .diagonal = static_cast<int>(best.j) - static_cast<int>(best.i) - b.diagonal,
+        .width = b.width,
+        .xdrop = -1
+    };
+    striped::StripedHit start = kernels::dispatch(kernels::BandedScan {}, rev1, rev2, reverse,
+                                                  params, best.score);
+
+    // Banded traceback inside the box, with the band moved to the box's own coordinates
+    size_t off1 = best.i - start.i, off2 = best.j - start.j;
+    BandParams box {
+        .diagonal = b.diagonal + static_cast<int>(off1) - static_cast<int>(off2),
+        .width = b.width,
+        .xdrop = -1
+    };
+    AlignmentResult result = smith_waterman_banded(seq1.substr(off1, start.i), seq2.substr(off2, start.j),
+                                                   box, params);
+    result.start1 += off1; result.end1 += off1;
+    result.start2 += off2; result.end2 += off2;
+    return result;
+}
@@ -2,19 +2,27 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <climits>
 #include <string.h>
 
-#include "align_sw.hpp"  // AlignmentResult struct
+#include "align_sw.hpp"  // AlignmentResult / ScoringParams
+#include "seq_encode.hpp"  // base codes
 
+// E/F start value; low enough that + gap_extend never overflows
+#define SW_NEG_INF (INT_MIN / 2)
+
+// One thread per cell of anti-diagonal `wave` (i + j == wave). seq1/seq2 are base codes.
+// Affine: E = gap consuming seq1 (up), F = gap consuming seq2 (left).
+template <bool Affine>
 __global__
 void smith_waterman_kernel_wavefront(
-    const char* seq1, const char* seq2,
-    int* H,
+    const uint8_t* seq1, const uint8_t* seq2,
+    int* H, int* E, int* F,
     int m, int n,
-    int match, int mismatch, int gap,
+    int match, int mismatch, int gap_open, int gap_extend,
     int wave) // 現在要算第 wave 條斜線
 {
-    int tx = threadIdx.x;
+    int tx = blockIdx.x * blockDim.x + threadIdx.x + max(1, wave - m);
     int ty = wave - tx;
 
     if (tx >= 1 && tx <= n && ty >= 1 && ty <= m) {
@@ -23,11 +31,19 @@ void smith_waterman_kernel_wavefront(
         int idx_up   = (ty-1) * (n + 1) + tx;
         int idx_left = ty * (n + 1) + (tx-1);
 
-        int score_match = (seq1[ty-1] == seq2[tx-1]) ? match : mismatch;
+        int score_match = (seq1[ty-1] == seq2[tx-1] && seq1[ty-1] != kBaseN) ? match : mismatch;
 
         int score_diag = H[idx_diag] + score_match;
-        int score_up = H[idx_up] + gap;
-        int score_left = H[idx_left] + gap;
+        int score_up, score_left;
+        if (Affine) {
+            score_up = max(H[idx_up] + gap_open, E[idx_up] + gap_extend);
+            score_left = max(H[idx_left] + gap_open, F[idx_left] + gap_extend);
+            E[idx] = score_up;
+            F[idx] = score_left;
+        } else {
+            score_up = H[idx_up] + gap_open;
+            score_left = H[idx_left] + gap_open;
+        }
 
         int max_score = max(0, max(score_diag, max(score_up, score_left)));
         H[idx] = max_score;
@@ -38,50 +54,70 @@ void smith_waterman_kernel_wavefront(
 AlignmentResult smith_waterman_cuda(
     const std::string& seq1,
     const std::string& seq2,
-    int match,
-    int mismatch,
-    int gap)
+    const ScoringParams& params)
 {
     size_t m = seq1.size(), n = seq2.size();
-    std::vector<int> H((m+1)*(n+1), 0);
+    size_t cells = (m + 1) * (n + 1);
+    bool affine = !params.is_linear();
+    std::vector<uint8_t> codes1 = encode_bases(seq1), codes2 = encode_bases(seq2);
+    std::vector<int> H(cells, 0);
+    std::vector<int> E(affine ? cells : 0, SW_NEG_INF), F(affine ? cells : 0, SW_NEG_INF);
 
     // Allocate device memory
-    char *d_seq1, *d_seq2;
-    int *d_H;
-    cudaMalloc(&d_seq1, m * sizeof(char));
-    cudaMalloc(&d_seq2, n * sizeof(char));
-    cudaMalloc(&d_H, (m + 1) * (n + 1) * sizeof(int));
+    uint8_t *d_seq1, *d_seq2;
+    int *d_H, *d_E = nullptr, *d_F = nullptr;
+    cudaMalloc(&d_seq1, m * sizeof(uint8_t));
+    cudaMalloc(&d_seq2, n * sizeof(uint8_t));
+    cudaMalloc(&d_H, cells * sizeof(int));
+    if (affine) {
+        cudaMalloc(&d_E, cells * sizeof(int));
+        cudaMalloc(&d_F, cells * sizeof(int));
+    }
 
     // Copy input to device
-    cudaMemcpy(d_seq1, seq1.data(), m * sizeof(char), cudaMemcpyHostToDevice);
-    cudaMemcpy(d_seq2, seq2.data(), n * sizeof(char), cudaMemcpyHostToDevice);
-    cudaMemcpy(d_H, H.data(), (m + 1) * (n + 1) * sizeof(int), cudaMemcpyHostToDevice);
-
-    // Launch kernel
-    dim3 blockSize(256);
-    dim3 gridSize((n + blockSize.x - 1) / blockSize.x, m);
-
-    // smith_waterman_kernel<<<gridSize, blockSize>>>(d_seq1, d_seq2, d_H, m, n, match, mismatch, gap);
-    // cudaDeviceSynchronize();
+    cudaMemcpy(d_seq1, codes1.data(), m * sizeof(uint8_t), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_seq2, codes2.data(), n * sizeof(uint8_t), cudaMemcpyHostToDevice);
+    cudaMemcpy(d_H, H.data(), cells * sizeof(int), cudaMemcpyHostToDevice);
+    if (affine) {
+        cudaMemcpy(d_E, E.data(), cells * sizeof(int), cudaMemcpyHostToDevice);
+        cudaMemcpy(d_F, F.data(), cells * sizeof(int), cudaMemcpyHostToDevice);
+    }
 
     // Wavefront computation
-    for (int wave = 2; wave <= m + n; ++wave) { // wave從2開始，因為座標都是從1開始
-        int num_threads = min(wave-1, (int)min((size_t)n, (size_t)m));
-    
+    const int block_size = 256;
+    for (int wave = 2; wave <= (int)(m + n); ++wave) { // wave從2開始，因為座標都是從1開始
+        int first = max(1, wave - (int)m);
+        int last = min((int)n, wave - 1);
+        int num_threads = last - first + 1;
+
         if (num_threads <= 0) continue; // 防止空 kernel
-    
-        smith_waterman_kernel_wavefront<<<1, wave>>>(d_seq1, d_seq2, d_H, m, n, match, mismatch, gap, wave);
+
+        int blocks = (num_threads + block_size - 1) / block_size;
+        if (affine)
+            smith_waterman_kernel_wavefront<true><<<blocks, block_size>>>(d_seq1, d_seq2, d_H, d_E, d_F, m, n,
+                params.match, params.mismatch, params.gap_open, params.gap_extend, wave);
+        else
+            smith_waterman_kernel_wavefront<false><<<blocks, block_size>>>(d_seq1, d_seq2, d_H, d_E, d_F, m, n,
+                params.match, params.mismatch, params.gap_open, params.gap_extend, wave);
         cudaDeviceSynchronize();
     }
 
 
     // Copy back results
-    cudaMemcpy(H.data(), d_H, (m + 1) * (n + 1) * sizeof(int), cudaMemcpyDeviceToHost);
+    cudaMemcpy(H.data(), d_H, cells * sizeof(int), cudaMemcpyDeviceToHost);
+    if (affine) {
+        cudaMemcpy(E.data(), d_E, cells * sizeof(int), cudaMemcpyDeviceToHost);
+        cudaMemcpy(F.data(), d_F, cells * sizeof(int), cudaMemcpyDeviceToHost);
+    }
 
     // Free device memory
     cudaFree(d_seq1);
     cudaFree(d_seq2);
     cudaFree(d_H);
+    if (affine) {
+        cudaFree(d_E);
+        cudaFree(d_F);
+    }
 
     // --- Find max score and position
     int max_score = 0;
@@ -96,59 +132,76 @@ AlignmentResult smith_waterman_cuda(
         }
     }
 
-    // --- Traceback
-    std::string aligned_seq1 = "";
-    std::string aligned_seq2 = "";
+    // --- Traceback (ops collected backwards, reversed once at the end)
+    std::string ops;
+    ops.reserve(max_i + max_j);
 
     int i = max_i;
     int j = max_j;
 
-    while (i > 0 && j > 0) {
-        int idx = i*(n+1) + j;
-        int idx_diag = (i-1)*(n+1) + (j-1);
-        int idx_up = (i-1)*(n+1) + j;
-        int idx_left = i*(n+1) + (j-1);
-
-        if (H[idx] == 0)
-            break;
-
-        if (H[idx] == H[idx_diag] + ((seq1[i-1] == seq2[j-1]) ? match : mismatch)) {
-            aligned_seq1 = seq1[i-1] + aligned_seq1;
-            aligned_seq2 = seq2[j-1] + aligned_seq2;
-            i--;
-            j--;
-        } else if (H[idx] == H[idx_left] + gap) {
-            aligned_seq1 = '-' + aligned_seq1;
-            aligned_seq2 = seq2[j-1] + aligned_seq2;
-            j--;
-        } else {
-            aligned_seq1 = seq1[i-1] + aligned_seq1;
-            aligned_seq2 = '-' + aligned_seq2;
-            i--;
+    if (!affine) {
+        int gap = params.gap_open;
+        while (i > 0 && j > 0) {
+            int idx = i*(n+1) + j;
+            int idx_diag = (i-1)*(n+1) + (j-1);
+            int idx_left = i*(n+1) + (j-1);
+
+            if (H[idx] == 0)
+                break;
+
+            if (H[idx] == H[idx_diag] + (bases_match(codes1[i-1], codes2[j-1]) ? params.match : params.mismatch)) {
+                ops.push_back('M');
+                i--;
+                j--;
+            } else if (H[idx] == H[idx_left] + gap) {
+                ops.push_back('I');
+                j--;
+            } else {
+                ops.push_back('D');
+                i--;
+            }
         }
-    }
-
-    int start1 = i;
-    int start2 = j;
+    } else {
+        // Gotoh traceback: state 0 = H, 1 = E (up), 2 = F (left)
+        int state = 0;
+        while (i > 0 && j > 0) {
+            int idx = i*(n+1) + j;
+            int idx_diag = (i-1)*(n+1) + (j-1);
+            int idx_up = (i-1)*(n+1) + j;
+            int idx_left = i*(n+1) + (j-1);
+
+            if (state == 0) {
+                if (H[idx] == 0)
+                    break;
+                if (H[idx] == H[idx_diag] + (bases_match(codes1[i-1], codes2[j-1]) ? params.match : params.mismatch)) {
+                    ops.push_back('M');
+                    i--;
+                    j--;
+                    continue;
+                }
+                state = (H[idx] == E[idx]) ? 1 : 2;
+            }
 
-    // --- Build match_line
-    std::string match_line = "";
-    for (size_t k = 0; k < aligned_seq1.size(); ++k) {
-        if (aligned_seq1[k] == aligned_seq2[k])
-            match_line += "|";
-        else if (aligned_seq1[k] == '-' || aligned_seq2[k] == '-')
-            match_line += " ";
-        else
-            match_line += "*";
+            if (state == 1) {
+                ops.push_back('D');
+                if (E[idx] == H[idx_up] + params.gap_open) state = 0;
+                i--;
+            } else {
+                ops.push_back('I');
+                if (F[idx] == H[idx_left] + params.gap_open) state = 0;
+                j--;
+            }
+        }
     }
+    std::reverse(ops.begin(), ops.end());
 
     // --- Return result
     AlignmentResult result;
-    result.aligned_seq1 = aligned_seq1;
-    result.aligned_seq2 = aligned_seq2;
-    result.match_line = match_line;
-    result.start1 = start1;
-    result.start2 = start2;
+    result.start1 = i;
+    result.end1 = max_i - 1;
+    result.start2 = j;
+    result.end2 = max_j - 1;
     result.score = max_score;
+    build_cigar(result, ops, seq1, seq2);
     return result;
 }
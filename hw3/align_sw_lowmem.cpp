@@ -0,0 +1,256 @@
+#include "align_sw_lowmem.hpp"
+#include "seq_encode.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+constexpr int kNegInf = std::numeric_limits<int>::min() / 2;
+
+template <bool Affine>
+AlignmentScore smith_waterman_score_impl(const std::string& seq1, const std::string& seq2,
+                                         const ScoringParams& p) {
+    size_t m = seq1.size(), n = seq2.size();
+    std::vector<uint8_t> codes1 = encode_bases(seq1);
+    QueryProfile profile(encode_bases(seq2), p);
+    // H holds row i-1 to the right of j and row i to the left of it
+    std::vector<int> H(n + 1, 0);
+    std::vector<int> E(Affine ? n + 1 : 0, kNegInf);
+
+    int max_score = 0, max_i = 0, max_j = 0;
+
+    for (size_t i = 1; i <= m; ++i) {
+        const int* prof = profile.row(codes1[i - 1]);
+        int diag = 0, F = kNegInf;
+        for (size_t j = 1; j <= n; ++j) {
+            int up = H[j];
+            int score_diag = diag + prof[j - 1];
+            int score_up, score_left;
+            if constexpr (Affine) {
+                E[j] = std::max(up + p.gap_open, E[j] + p.gap_extend);
+                F = std::max(H[j - 1] + p.gap_open, F + p.gap_extend);
+                score_up = E[j];
+                score_left = F;
+            } else {
+                score_up = up + p.gap_open;
+                score_left = H[j - 1] + p.gap_open;
+            }
+
+            diag = up;
+            H[j] = std::max({0, score_diag, score_up, score_left});
+
+            if (H[j] > max_score) {
+                max_score = H[j];
+                max_i = i;
+                max_j = j;
+            }
+        }
+    }
+
+    return AlignmentScore { .score = max_score, .end1 = max_i - 1, .end2 = max_j - 1 };
+}
+
+// Walk backwards from the end cell with the alignment anchored there (no zero floor) and
+// return the prefix lengths of the first cell reaching `target`, i.e. the alignment length.
+std::pair<size_t, size_t> find_start(const std::vector<uint8_t>& codes1, const QueryProfile& profile,
+                                     const AlignmentScore& best, const ScoringParams& p) {
+    size_t m = best.end1 + 1, n = best.end2 + 1;
+    std::vector<int> H(n + 1, kNegInf), E(n + 1, kNegInf);
+    H[0] = 0;
+
+    for (size_t i = 1; i <= m; ++i) {
+        const int* prof = profile.row(codes1[m - i]);
+        int diag = H[0], F = kNegInf;
+        H[0] = kNegInf;
+        for (size_t j = 1; j <= n; ++j) {
+            int up = H[j];
+            E[j] = std::max(up + p.gap_open, E[j] + p.gap_extend);
+            F = std::max(H[j - 1] + p.gap_open, F + p.gap_extend);
+            H[j] = std::max({diag + prof[n - j], E[j], F});
+            diag = up;
+            if (H[j] == best.score) return { i, j };
+        }
+    }
+    return { m, n };  // unreachable when `best` came from a local score pass
+}
+
+// Myers-Miller: Hirschberg divide and conquer for affine global alignment.
+// A gap of length L scores G + X * L with G = gap_open - gap_extend and X = gap_extend.
+// tb / te is the open cost of a seq1 deletion touching the start / end of the subproblem:
+// G normally, 0 when the deletion continues one from the enclosing problem.
+class MyersMiller {
+public:
+    // `max_cols` bounds the seq2 length of any subproblem passed to align()
+    MyersMiller(const std::vector<uint8_t>& a, const QueryProfile& b, size_t max_cols, const ScoringParams& params)
+        : A(a), B(b),
+          G(params.gap_open - params.gap_extend), X(params.gap_extend),
+          CC(max_cols + 1), DD(max_cols + 1), RR(max_cols + 1), SS(max_cols + 1) {}
+
+    // Edit script: 'M' aligned pair, 'D' seq1 char against a gap, 'I' gap against a seq2 char
+    std::string ops;
+
+    void align(size_t a0, size_t m, size_t b0, size_t n, int tb, int te) {
+        if (n == 0) {
+            ops.append(m, 'D');
+            return;
+        }
+        if (m == 0) {
+            ops.append(n, 'I');
+            return;
+        }
+        if (m == 1) {
+            align_single(a0, b0, n, tb, te);
+            return;
+        }
+
+        size_t mid = m / 2;
+        forward(a0, mid, b0, n, tb);
+        reverse(a0 + mid, m - mid, b0, n, te);
+
+        // Type 1 splits between two cells; type 2 splits inside one deletion across the middle
+        size_t best_j = 0;
+        bool through_gap = false;
+        int best = kNegInf;
+        for (size_t j = 0; j <= n; ++j) {
+            if (CC[j] + RR[j] > best) {
+                best = CC[j] + RR[j];
+                best_j = j;
+                through_gap = false;
+            }
+            if (DD[j] + SS[j] - G > best) {
+                best = DD[j] + SS[j] - G;
+                best_j = j;
+                through_gap = true;
+            }
+        }
+
+        if (!through_gap) {
+            align(a0, mid, b0, best_j, tb, G);
+            align(a0 + mid, m - mid, b0 + best_j, n - best_j, G, te);
+        } else {
+            align(a0, mid - 1, b0, best_j, tb, 0);
+            ops.append(2, 'D');
+            align(a0 + mid + 1, m - mid - 1, b0 + best_j, n - best_j, 0, te);
+        }
+    }
+
+private:
+    const std::vector<uint8_t>& A;   // seq1 codes
+    const QueryProfile& B;           // seq2 profile
+    int G, X;
+    // CC/DD: best score / best ending in a deletion of A[a0, a0+rows) vs B[b0, b0+j)
+    // RR/SS: the same for the lower half against the suffix B[b0+j, b0+n)
+    std::vector<int> CC, DD, RR, SS;
+
+    int gap(size_t len) const { return len ? G + X * static_cast<int>(len) : 0; }
+
+    void forward(size_t a0, size_t rows, size_t b0, size_t n, int tb) {
+        CC[0] = 0;
+        for (size_t j = 1; j <= n; ++j) {
+            CC[j] = gap(j);
+            DD[j] = CC[j] + G;
+        }
+        for (size_t i = 1; i <= rows; ++i) {
+            int t = CC[0];
+            int c = CC[0] = DD[0] = tb + X * static_cast<int>(i);
+            int e = kNegInf;
+            for (size_t j = 1; j <= n; ++j) {
+                e = std::max(e, c + G) + X;
+                int d = std::max(DD[j], CC[j] + G) + X;
+                c = std::max({d, e, t + B.row(A[a0 + i - 1])[b0 + j - 1]});
+                t = CC[j];
+                CC[j] = c;
+                DD[j] = d;
+            }
+        }
+    }
+
+    void reverse(size_t a0, size_t rows, size_t b0, size_t n, int te) {
+        RR[n] = 0;
+        for (size_t j = n; j-- > 0;) {
+            RR[j] = gap(n - j);
+            SS[j] = RR[j] + G;
+        }
+        for (size_t i = 1; i <= rows; ++i) {
+            int t = RR[n];
+            int c = RR[n] = SS[n] = te + X * static_cast<int>(i);
+            int e = kNegInf;
+            for (size_t j = n; j-- > 0;) {
+                e = std::max(e, c + G) + X;
+                int d = std::max(SS[j], RR[j] + G) + X;
+                c = std::max({d, e, t + B.row(A[a0 + rows - i])[b0 + j]});
+                t = RR[j];
+                RR[j] = c;
+                SS[j] = d;
+            }
+        }
+    }
+
+    // One seq1 character: either it pairs with some B[j] or it is deleted
+    void align_single(size_t a0, size_t b0, size_t n, int tb, int te) {
+        int best = std::max(tb, te) + X + gap(n);
+        size_t best_j = n;  // n means "deleted"
+        const int* prof = B.row(A[a0]);
+        for (size_t j = 0; j < n; ++j) {
+            int score = gap(j) + prof[b0 + j] + gap(n - j - 1);
+            if (score > best) {
+                best = score;
+                best_j = j;
+            }
+        }
+
+        if (best_j < n) {
+            ops.append(best_j, 'I');
+            ops.push_back('M');
+            ops.append(n - best_j - 1, 'I');
+        } else if (tb == 0 || te != 0) {
+            ops.push_back('D');   // keep the deletion next to the one it continues
+            ops.append(n, 'I');
+        } else {
+            ops.append(n, 'I');
+            ops.push_back('D');
+        }
+    }
+};
+
+} // namespace
+
+AlignmentScore smith_waterman_score(const std::string& seq1, const std::string& seq2,
+                                    const ScoringParams& params) {
+    if (params.is_linear())
+        return smith_waterman_score_impl<false>(seq1, seq2, params);
+    return smith_waterman_score_impl<true>(seq1, seq2, params);
+}
+
+AlignmentResult traceback_linear_space(const std::string& seq1, const std::string& seq2,
+                                       const AlignmentScore& best, const ScoringParams& params) {
+    if (best.score <= 0)
+        return empty_result();
+
+    std::vector<uint8_t> codes1 = encode_bases(seq1);
+    QueryProfile profile(encode_bases(seq2), params);
+
+    auto [len1, len2] = find_start(codes1, profile, best, params);
+    int start1 = best.end1 + 1 - static_cast<int>(len1);
+    int start2 = best.end2 + 1 - static_cast<int>(len2);
+
+    MyersMiller mm(codes1, profile, len2, params);
+    int G = params.gap_open - params.gap_extend;
+    mm.ops.reserve(len1 + len2);
+    mm.align(start1, len1, start2, len2, G, G);
+
+    AlignmentResult result;
+    result.score = best.score;
+    result.start1 = start1;
+    result.end1 = best.end1;
+    result.start2 = start2;
+    result.end2 = best.end2;
+    build_cigar(result, mm.ops, seq1, seq2);
+    return result;
+}
+
+AlignmentResult smith_waterman_linear_space(const std::string& seq1, const std::string& seq2,
+                                            const ScoringParams& params) {
+    return traceback_linear_space(seq1, seq2, smith_waterman_score(seq1, seq2, params), params);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include "align_sw.hpp"  // Reuse AlignmentResult, AlignmentScore and ScoringParams
+
+// Score-only Smith-Waterman: keeps a single rolling DP row, O(n) memory.
+AlignmentScore smith_waterman_score(
+    const std::string& seq1,
+    const std::string& seq2,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Local alignment in O(m + n) memory: score-only pass for the end cell, an anchored
+// reverse pass for the start cell, then a Hirschberg (Myers-Miller) traceback of that region.
+// Score and end cell are smith_waterman's; among alignments of equal score it may return
+// another one (a different start cell and CIGAR).
+AlignmentResult smith_waterman_linear_space(
+    const std::string& seq1,
+    const std::string& seq2,
+    const ScoringParams& params = ScoringParams{}
+);
+
+// Same as above for an end cell that is already known (e.g. from the SIMD score pass).
+AlignmentResult traceback_linear_space(
+    const std::string& seq1,
+    const std::string& seq2,
+    const AlignmentScore& best,
+    const ScoringParams& params = ScoringParams{}
+);
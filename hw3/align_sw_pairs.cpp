@@ -0,0 +1,91 @@
+#include "align_sw_pairs.hpp"
+#include "align_sw_simd.hpp"
+#include "worker_pool.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+std::vector<SequencePair> cross_pairs(size_t count1, size_t count2) {
+    std::vector<SequencePair> pairs;
+    pairs.reserve(count1 * count2);
+    for (size_t a = 0; a < count1; ++a)
+        for (size_t b = 0; b < count2; ++b)
+            pairs.push_back(SequencePair { a, b });
+    return pairs;
+}
+
+std::vector<SequencePair> all_vs_all_pairs(size_t count) {
+    std::vector<SequencePair> pairs;
+    pairs.reserve(count * (count - (count > 0)) / 2);
+    for (size_t a = 0; a < count; ++a)
+        for (size_t b = a + 1; b < count; ++b)
+            pairs.push_back(SequencePair { a, b });
+    return pairs;
+}
+
+namespace {
+
+// Pairs a worker may run ahead of the oldest pair not yet emitted, per thread
+constexpr size_t kLookAhead = 16;
+
+} // namespace
+
+void align_pairs(const std::vector<std::string>& seqs1, const std::vector<std::string>& seqs2,
+                 const std::vector<SequencePair>& pairs,
+                 const std::function<void(size_t, const AlignmentResult&)>& emit,
+                 const ScoringParams& params, unsigned threads) {
+    if (pairs.empty()) return;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, pairs.size())));
+
+    auto cost = [&](size_t k) {
+        return static_cast<double>(seqs1[pairs[k].first].size()) * seqs2[pairs[k].second].size();
+    };
+
+    // Window [next_emit, next_emit + window): the only pairs that may be running or waiting to
+    // be emitted, so slot k % window of the reorder buffer belongs to pair k
+    struct Slot {
+        bool started = false;
+        std::optional<AlignmentResult> result;
+    };
+    const size_t window = std::min(pairs.size(), kLookAhead * threads);
+    std::vector<Slot> slots(window);
+    size_t next_emit = 0, started = 0;
+    std::mutex mutex;
+    std::condition_variable progress;
+
+    auto worker = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (started < pairs.size()) {
+            // the costliest pair of the window not started yet
+            size_t pick = pairs.size();
+            for (size_t k = next_emit, end = std::min(pairs.size(), next_emit + window); k < end; ++k)
+                if (!slots[k % window].started && (pick == pairs.size() || cost(k) > cost(pick)))
+                    pick = k;
+            if (pick == pairs.size()) {
+                // all started: wait for the oldest to be emitted and the window to move
+                progress.wait(lock);
+                continue;
+            }
+            slots[pick % window].started = true;
+            ++started;
+
+            lock.unlock();
+            AlignmentResult result = smith_waterman_simd(seqs1[pairs[pick].first], seqs2[pairs[pick].second],
+                                                         params);
+            lock.lock();
+
+            slots[pick % window].result = std::move(result);
+            size_t before = next_emit;
+            for (Slot* slot; next_emit < pairs.size() && (slot = &slots[next_emit % window])->result; ++next_emit) {
+                emit(next_emit, *slot->result);
+                *slot = Slot {};
+            }
+            if (next_emit != before) progress.notify_all();
+        }
+    };
+
+    WorkerPool::shared().run(threads, worker);
+}
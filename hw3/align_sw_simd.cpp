@@ -1,65 +1,116 @@
 #include "align_sw_simd.hpp"
-#include <xsimd/xsimd.hpp>
+#include "align_sw_kernels.hpp"
+#include "align_sw_lowmem.hpp"
 #include <vector>
-#include <algorithm>
-#include <iostream>
 
-AlignmentResult smith_waterman_simd(const std::string& seq1, const std::string& seq2,
-                                    int match, int mismatch, int gap) {
-    using namespace xsimd;
-    size_t m = seq1.size(), n = seq2.size();
-    const std::size_t vec_size = batch<int>::size;
-
-    // 矩陣行（橫向）一維化儲存
-    std::vector<int> H((m + 1) * (n + 1), 0);
-
-    auto idx = [&](int i, int j) { return i * (n + 1) + j; };
-
-    int max_score = 0;
-    int max_i = 0, max_j = 0;
-
-    for (size_t i = 1; i <= m; ++i) {
-        for (size_t j = 1; j <= n; j += vec_size) {
-            batch<int> score_diag, score_up, score_left;
-            batch<int> current;
-
-            // 加載前一列的值
-            batch<int> prev_row = batch<int>::load_unaligned(&H[idx(i - 1, j)]);
-            batch<int> prev_diag = batch<int>::load_unaligned(&H[idx(i - 1, j - 1)]);
-            batch<int> left = batch<int>::load_unaligned(&H[idx(i, j - 1)]);
-
-            // 建立分數比較
-            std::array<int, vec_size> match_arr;
-            for (std::size_t k = 0; k < vec_size; ++k) {
-                if (j + k <= n) {
-                    match_arr[k] = (seq1[i - 1] == seq2[j + k - 1]) ? match : mismatch;
-                } else {
-                    match_arr[k] = 0;
-                }
-            }
-
-            batch<int> match_score = batch<int>::load_unaligned(match_arr.data());
-
-            score_diag = prev_diag + match_score;
-            score_up = prev_row + batch<int>(gap);
-            score_left = left + batch<int>(gap);
-
-            current = max(score_diag, score_up);
-            current = max(current, score_left);
-            current = max(current, batch<int>(0));
-
-            current.store_unaligned(&H[idx(i, j)]);
-
-            for (std::size_t k = 0; k < vec_size; ++k) {
-                if (j + k <= n && H[idx(i, j + k)] > max_score) {
-                    max_score = H[idx(i, j + k)];
-                    max_i = i;
-                    max_j = j + k;
-                }
-            }
-        }
+namespace {
+
+using striped::StripedHit;
+
+StripedHit striped_sw(const uint8_t* db, size_t m, const QueryProfile& query,
+                      const ScoringParams& p, int target = -1) {
+    return kernels::dispatch(kernels::StripedScan {}, db, m, query, p, target);
+}
+
+bool cpu_supports(const std::string& level) {
+    auto cpu = xsimd::available_architectures();
+    if (level == xsimd::sse2::name()) return cpu.sse2;
+    if (level == xsimd::sse4_1::name()) return cpu.sse4_1;
+    if (level == xsimd::avx2::name()) return cpu.avx2;
+    if (level == xsimd::avx512bw::name()) return cpu.avx512bw;
+    return false;
+}
+
+std::string& forced_level() {
+    static std::string level;
+    return level;
+}
+
+} // namespace
+
+const std::string& kernels::forced_simd_level() {
+    return forced_level();
+}
+
+bool set_simd_level(const std::string& level) {
+    if (level == "auto") {
+        forced_level().clear();
+        return true;
     }
+    if (!cpu_supports(level))
+        return false;
+    forced_level() = level;
+    return true;
+}
+
+std::string simd_level() {
+    return kernels::dispatch(kernels::ArchName {});
+}
+
+namespace {
+
+// Full alignment ending at `best`: a reverse pass over the prefixes ending there finds every
+// cell that starts an alignment of the best score, so the box spanned by them holds the path.
+// The scalar traceback then runs only inside that box; its H values agree with the full matrix
+// along the path, so the alignment is the same one smith_waterman reports.
+AlignmentResult traceback_box(const std::string& seq1, const std::string& seq2,
+                              const std::vector<uint8_t>& codes1, const std::vector<uint8_t>& codes2,
+                              StripedHit best, const ScoringParams& params) {
+    if (best.score == 0)
+        return empty_result();
+
+    size_t m = codes1.size(), n = codes2.size();
+    std::vector<uint8_t> rev1(codes1.rbegin() + (m - best.i), codes1.rend());
+    std::vector<uint8_t> rev2(codes2.rbegin() + (n - best.j), codes2.rend());
+    StripedHit start = striped_sw(rev1.data(), rev1.size(), QueryProfile(rev2, params),
+                                  params, best.score);
+
+    size_t off1 = best.i - start.i, off2 = best.j - start.j;
+    AlignmentResult result = smith_waterman(seq1.substr(off1, start.i), seq2.substr(off2, start.j),
+                                            params);
+    result.start1 += off1; result.end1 += off1;
+    result.start2 += off2; result.end2 += off2;
+    return result;
+}
+
+} // namespace
+
+AlignmentResult smith_waterman_simd(const std::string& seq1, const std::string& seq2,
+                                    const ScoringParams& params) {
+    if (!striped::handles(params))
+        return smith_waterman(seq1, seq2, params);
+
+    std::vector<uint8_t> codes1 = encode_bases(seq1), codes2 = encode_bases(seq2);
+    StripedHit best;
+    if (!seq1.empty() && !seq2.empty())
+        best = striped_sw(codes1.data(), codes1.size(), QueryProfile(codes2, params), params);
+    return traceback_box(seq1, seq2, codes1, codes2, best, params);
+}
+
+AlignmentResult traceback_simd(const std::string& seq1, const std::string& seq2,
+                               const AlignmentScore& best, const ScoringParams& params) {
+    // the end cell is smith_waterman's too, so the scalar aligner gives the same alignment
+    if (!striped::handles(params))
+        return smith_waterman(seq1, seq2, params);
+
+    StripedHit hit;
+    if (best.score > 0)
+        hit = StripedHit { best.score, static_cast<size_t>(best.end1) + 1, static_cast<size_t>(best.end2) + 1 };
+    return traceback_box(seq1, seq2, encode_bases(seq1), encode_bases(seq2), hit, params);
+}
+
+AlignmentScore smith_waterman_simd_score(const std::string& seq1, const std::string& seq2,
+                                         const ScoringParams& params) {
+    if (!striped::handles(params))
+        return smith_waterman_score(seq1, seq2, params);
 
-    // 🟡 只使用 scalar traceback
-    return smith_waterman(seq1, seq2, match, mismatch, gap);
+    StripedHit best;
+    if (!seq1.empty() && !seq2.empty())
+        best = striped_sw(encode_bases(seq1).data(), seq1.size(), QueryProfile(encode_bases(seq2), params),
+                          params);
+    return AlignmentScore {
+        .score = best.score,
+        .end1 = static_cast<int>(best.i) - 1,
+        .end2 = static_cast<int>(best.j) - 1
+    };
 }
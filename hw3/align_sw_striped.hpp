@@ -0,0 +1,239 @@
+#pragma once
+// Farrar striped Smith-Waterman kernel shared by the SIMD, batch and tiled multithreaded engines.
+// Internal header: only align_sw_kernels.cpp includes it, once per instruction set. Everything
+// here has internal linkage, so the linker never merges a copy built for a wider instruction
+// set into the baseline one.
+#include <xsimd/xsimd.hpp>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "align_sw_kernels.hpp"
+
+namespace striped {
+namespace {
+
+template <class T, class Arch>
+using aligned_vector = std::vector<T, xsimd::aligned_allocator<T, Arch::alignment()>>;
+
+constexpr int kNegInf = std::numeric_limits<int>::min() / 2;
+
+// Score lanes come in int8, int16 and int32. The narrow ones add with saturation (as in SSW),
+// so a cell that overflows pins at the top instead of wrapping around. A run is exact when its
+// best score stays below score_ceiling<T>(); otherwise it has to be repeated one type wider.
+// The narrow types also need small penalties, so that no intermediate value wraps at the bottom.
+template <class T>
+inline bool lanes_fit(const ScoringParams& p) {
+    if constexpr (sizeof(T) >= sizeof(int)) {
+        return true;
+    } else {
+        constexpr int limit = std::numeric_limits<T>::max() / 4;
+        auto penalty = [](int v) { return v <= 0 && v >= -limit; };
+        return p.match > 0 && p.match <= limit && penalty(p.mismatch)
+            && penalty(p.gap_open) && penalty(p.gap_extend);
+    }
+}
+
+template <class T>
+inline int score_ceiling(const ScoringParams& p) {
+    if constexpr (sizeof(T) >= sizeof(int))
+        return std::numeric_limits<int>::max();
+    else  // the largest step any add takes upward: a match, or F catching up in lazy-F
+        return std::numeric_limits<T>::max() - std::max(p.match, p.gap_open - p.gap_extend);
+}
+
+template <class T, class Arch>
+inline xsimd::batch<T, Arch> adds(const xsimd::batch<T, Arch>& a, const xsimd::batch<T, Arch>& b) {
+    if constexpr (sizeof(T) < sizeof(int))
+        return xsimd::sadd(a, b);
+    else
+        return a + b;
+}
+
+// Profile score for query padding lanes: low enough that padding never wins a max.
+template <class T>
+constexpr T pad_score() {
+    return sizeof(T) < sizeof(int) ? std::numeric_limits<T>::min() : std::numeric_limits<T>::min() / 4;
+}
+
+// Row-major first of two hits with the same score wins, like smith_waterman's strict `>` scan
+inline bool better_hit(const StripedHit& a, const StripedHit& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.i != b.i ? a.i < b.i : a.j < b.j;
+}
+
+// Lane k takes lane k-1, lane 0 takes `fill`. The wrapping subtract and add cancel out.
+template <class T, class Arch>
+inline xsimd::batch<T, Arch> shift_in(const xsimd::batch<T, Arch>& v, const xsimd::batch<T, Arch>& fill) {
+    return xsimd::slide_left<sizeof(T)>(v - fill) + fill;
+}
+
+// Boundary column to the left of a band: h[r] = H(row0 + r, j0 - 1) for r = 0..rows and
+// f[r] = F(row0 + r, j0 - 1). fill() overwrites both with the band's own last column,
+// which is the left boundary of the band to its right.
+struct LeftBoundary {
+    int* h;
+    int* f;   // affine only
+};
+
+// Columns [j0, j0 + n) of the DP matrix: the striped query profile for that slice plus the
+// H and E rows below the last filled row. Query column j0 + j lives in segment j % seg_len,
+// lane j / seg_len, so the left-neighbour dependency only crosses lanes at the segment wrap,
+// which the lazy-F loop corrects afterwards.
+//
+// Affine gaps keep E (up) in a striped row buffer and F (left) in a register;
+// the linear instantiation derives both straight from H. T is the score lane type:
+// boundaries (LeftBoundary) are only supported on int lanes.
+template <class T, bool Affine, class Arch>
+class StripedBand {
+public:
+    StripedBand(const QueryProfile& query, size_t j0, size_t n, const ScoringParams& params)
+        : p(params), col0(j0), n(n), seg_len((n + V - 1) / V),
+          profile(kAlphabetSize * seg_len * V),
+          h_load(seg_len * V, 0), h_store(seg_len * V, 0),
+          e_store(Affine ? seg_len * V : 0, params.gap_open) {
+        // 把每個 symbol 的 query profile 排成 striped 版本
+        for (uint8_t c = 0; c < kAlphabetSize; ++c) {
+            const int* scores = query.row(c) + j0;
+            T* row = &profile[c * seg_len * V];
+            for (size_t k = 0; k < seg_len; ++k) {
+                for (size_t l = 0; l < V; ++l) {
+                    size_t j = l * seg_len + k;
+                    row[k * V + l] = j < n ? static_cast<T>(scores[j]) : pad_score<T>();
+                }
+            }
+        }
+        alignas(64) T lanes[V];
+        for (size_t l = 0; l < V; ++l) lanes[l] = static_cast<T>(l);
+        lane0 = batch::load_unaligned(lanes) == batch(0);
+    }
+
+    // Fill DP rows row0 + 1 .. row0 + rows with base codes `db`. Without a left boundary the
+    // band starts at the matrix edge (H = 0, no F).
+    //
+    // target < 0 : raise `hit` to the best cell, first in row-major order on ties.
+    // target >= 0: last row and largest column holding a cell that scores exactly `target`.
+    //
+    // Returns the best cell value seen. At score_ceiling<T>() or above the band has saturated:
+    // it stops early and `hit` is meaningless.
+    int fill(const uint8_t* db, size_t rows, size_t row0, const LeftBoundary* left,
+             StripedHit& hit, int target = -1) {
+        const batch v_open(p.gap_open), v_ext(p.gap_extend), v_zero(0);
+        // A lazy-F lane still matters while F + extend beats H + open
+        const batch v_f_slack(p.gap_open - p.gap_extend);
+        // Segment and lane of the band's last column, exported through `left`
+        const size_t k_last = (n - 1) % seg_len, l_last = (n - 1) / seg_len;
+        const int ceiling = score_ceiling<T>(p);
+        int band_max = 0;
+
+        T diag_left = 0;
+        if (left) {
+            diag_left = static_cast<T>(left->h[0]);
+            left->h[0] = h_store[k_last * V + l_last];
+        }
+
+        for (size_t r = 1; r <= rows; ++r) {
+            const T* prof = &profile[db[r - 1] * seg_len * V];
+
+            // Left neighbour of column j0 in this row, then F entering the band
+            int h_left = left ? left->h[r] : 0;
+            int f_in = h_left + p.gap_open;
+            if (Affine && left) f_in = std::max(f_in, left->f[r] + p.gap_extend);
+            const batch v_f_fill = xsimd::select(lane0, batch(static_cast<T>(f_in)), v_open);
+
+            batch v_f = v_f_fill;
+            batch v_h = xsimd::slide_left<sizeof(T)>(batch::load_aligned(&h_store[(seg_len - 1) * V]));
+            v_h = xsimd::select(lane0, batch(diag_left), v_h);
+            std::swap(h_load, h_store);
+            batch v_max = v_zero;
+            batch v_f_last = v_open;   // F of the last column's segment
+
+            for (size_t k = 0; k < seg_len; ++k) {
+                batch v_up = batch::load_aligned(&h_load[k * V]);
+                batch v_e = Affine ? batch::load_aligned(&e_store[k * V]) : adds(v_up, v_open);
+                if (Affine && k == k_last) v_f_last = v_f;
+                v_h = adds(v_h, batch::load_aligned(prof + k * V));
+                v_h = xsimd::max(v_h, v_e);
+                v_h = xsimd::max(v_h, v_f);
+                v_h = xsimd::max(v_h, v_zero);
+                v_max = xsimd::max(v_max, v_h);
+                v_h.store_aligned(&h_store[k * V]);
+
+                if constexpr (Affine) {
+                    xsimd::max(adds(v_e, v_ext), adds(v_h, v_open)).store_aligned(&e_store[k * V]);
+                    v_f = xsimd::max(adds(v_f, v_ext), adds(v_h, v_open));
+                } else {
+                    v_f = adds(v_h, v_open);
+                }
+                v_h = v_up;  // diagonal of the next segment
+            }
+
+            // Lazy-F: carry the left gaps across the lane boundary until no lane improves
+            size_t k = 0;
+            v_f = xsimd::select(lane0, v_f_fill, xsimd::slide_left<sizeof(T)>(v_f));
+            batch v_cur = batch::load_aligned(&h_store[0]);
+            for (;;) {
+                if (Affine && k == k_last) v_f_last = xsimd::max(v_f_last, v_f);
+                if (!xsimd::any(v_f > adds(v_cur, v_f_slack))) break;
+                v_cur = xsimd::max(v_cur, v_f);
+                v_cur.store_aligned(&h_store[k * V]);
+                v_max = xsimd::max(v_max, v_cur);
+                if constexpr (Affine) {
+                    batch v_e = batch::load_aligned(&e_store[k * V]);
+                    xsimd::max(v_e, adds(v_cur, v_open)).store_aligned(&e_store[k * V]);
+                }
+                v_f = adds(v_f, v_ext);
+                if (++k == seg_len) {
+                    k = 0;
+                    v_f = shift_in(v_f, v_open);
+                }
+                v_cur = batch::load_aligned(&h_store[k * V]);
+            }
+
+            if (left) {
+                left->h[r] = h_store[k_last * V + l_last];
+                if constexpr (Affine) {
+                    alignas(64) T lanes[V];
+                    v_f_last.store_aligned(lanes);
+                    left->f[r] = lanes[l_last];
+                }
+            }
+            diag_left = h_left;
+
+            int row_max = xsimd::reduce_max(v_max);
+            band_max = std::max(band_max, row_max);
+            if (band_max >= ceiling) return band_max;   // saturated, to be re-run wider
+            if (target < 0 ? row_max <= hit.score : row_max < target) continue;
+
+            // Only rows that reach the best (or the target) are scanned lane by lane
+            size_t i = row0 + r;
+            for (size_t j = 0; j < n; ++j) {
+                int h = h_store[(j % seg_len) * V + j / seg_len];
+                if (target < 0) {
+                    if (h > hit.score) {
+                        hit.score = h;
+                        hit.i = i;
+                        hit.j = col0 + j + 1;
+                    }
+                } else if (h == target) {
+                    hit.score = h;
+                    hit.i = i;
+                    hit.j = std::max(hit.j, col0 + j + 1);
+                }
+            }
+        }
+        return band_max;
+    }
+
+private:
+    using batch = xsimd::batch<T, Arch>;
+    static constexpr size_t V = batch::size;
+
+    ScoringParams p;
+    size_t col0, n, seg_len;
+    aligned_vector<T, Arch> profile;
+    aligned_vector<T, Arch> h_load, h_store, e_store;
+    xsimd::batch_bool<T, Arch> lane0;
+};
+
+} // namespace
+} // namespace striped
@@ -0,0 +1,77 @@
+#pragma once
+// Traceback storage and walk shared by the full-matrix and banded scalar aligners.
+// Internal header: only align_sw.cpp and align_sw_banded.cpp include it.
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Traceback codes: bits 0-1 = source of H (0 H is zero, 1 diag, 2 up/E, 3 left/F),
+// bit 2 = E extends E(i-1, j), bit 3 = F extends F(i, j-1).
+constexpr uint8_t kFromZero = 0, kFromDiag = 1, kFromUp = 2, kFromLeft = 3;
+constexpr uint8_t kSourceMask = 3, kExtendUp = 4, kExtendLeft = 8;
+
+// Lowest score the E/F recurrences may start from without overflowing on + gap_extend
+constexpr int kNegInf = std::numeric_limits<int>::min() / 2;
+
+// Traceback codes for cells (1..rows, 1..cols) in one contiguous row-major buffer,
+// `Bits` (2 or 4) bits per cell. Rows are padded to whole bytes.
+template <unsigned Bits>
+class PackedTraceback {
+public:
+    PackedTraceback(size_t rows, size_t cols)
+        : row_bytes((cols * Bits + 7) / 8), data(rows * row_bytes, 0) {}
+
+    void set(size_t i, size_t j, uint8_t code) {
+        size_t bit = (j - 1) * Bits;
+        data[(i - 1) * row_bytes + bit / 8] |= static_cast<uint8_t>(code << (bit % 8));
+    }
+
+    uint8_t get(size_t i, size_t j) const {
+        size_t bit = (j - 1) * Bits;
+        return (data[(i - 1) * row_bytes + bit / 8] >> (bit % 8)) & ((1u << Bits) - 1);
+    }
+
+private:
+    size_t row_bytes;
+    std::vector<uint8_t> data;
+};
+
+// Walk back from the cell (i, j) through code_at(i, j) and return the edit script in forward
+// order ('M' aligned pair, 'D' seq1 char against a gap, 'I' gap against a seq2 char).
+// On return (i, j) are the prefix lengths in front of the alignment, i.e. its 0-based start.
+template <bool Affine, class CodeAt>
+std::string walk_traceback(const CodeAt& code_at, int& i, int& j) {
+    // `state` is the matrix the path is in (0 = H, kFromUp = E, kFromLeft = F).
+    // Ops are appended walking backwards and reversed once at the end.
+    std::string ops;
+    ops.reserve(i + j);
+    uint8_t state = 0;
+
+    while (i > 0 && j > 0) {
+        uint8_t code = code_at(i, j);
+        if (state == 0) {
+            uint8_t source = code & kSourceMask;
+            if (source == kFromZero) break;
+            if (source == kFromDiag) {
+                ops.push_back('M');
+                --i; --j;
+                continue;
+            }
+            state = source;
+        }
+
+        if (state == kFromUp) {
+            ops.push_back('D');
+            if (!Affine || !(code & kExtendUp)) state = 0;
+            --i;
+        } else {
+            ops.push_back('I');
+            if (!Affine || !(code & kExtendLeft)) state = 0;
+            --j;
+        }
+    }
+    std::reverse(ops.begin(), ops.end());
+    return ops;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+// One line of a samtools .fai index: NAME LENGTH OFFSET LINEBASES LINEWIDTH
+struct FaiEntry {
+    std::string name;
+    uint64_t length = 0;       // bases in the sequence
+    uint64_t offset = 0;       // byte offset of the first base
+    uint64_t line_bases = 0;   // bases per full line
+    uint64_t line_width = 0;   // bytes per full line, line break included
+};
+
+// Bases [start, end) of one sequence, 0-based half-open
+struct FastaRegion {
+    std::string name;
+    uint64_t start = 0, end = 0;
+};
+
+// Memory-mapped FASTA file with a .fai index. The index is loaded from `<file>.fai` when it
+// exists and is newer than the FASTA, otherwise built from the mapping and written back
+// (silently skipped if the directory is read-only). A region fetch only touches the pages
+// that hold it. Errors throw std::runtime_error.
+class IndexedFasta {
+public:
+    explicit IndexedFasta(const std::string& filename);
+    ~IndexedFasta();
+    IndexedFasta(const IndexedFasta&) = delete;
+    IndexedFasta& operator=(const IndexedFasta&) = delete;
+
+    const std::vector<FaiEntry>& entries() const { return index; }
+    const FaiEntry& entry(const std::string& name) const;
+
+    // samtools region syntax: "name", "name:start" or "name:start-end" (1-based, inclusive,
+    // commas allowed). The result is clipped to the sequence length.
+    FastaRegion resolve(const std::string& region) const;
+
+    std::string fetch(const FastaRegion& region) const;
+    std::string fetch(const std::string& region) const { return fetch(resolve(region)); }
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<FaiEntry> index;
+    std::unordered_map<std::string, size_t> by_name;
+
+    void build_index();
+    bool load_index(const std::string& fai_path);
+    void save_index(const std::string& fai_path) const;
+};
@@ -1,4 +1,44 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <fstream>
+#include <vector>
 
+// One FASTA/FASTQ record. The views point into the reader's buffer and are only
+// valid until the next call to SequenceReader::next().
+struct SequenceRecord {
+    std::string_view name;      // header up to the first whitespace
+    std::string_view comment;   // rest of the header line
+    std::string_view seq;       // line breaks removed
+    std::string_view qual;      // FASTQ only, empty for FASTA
+};
+
+// Streaming multi-record FASTA/FASTQ reader. The file is read in chunks into a single
+// buffer and multi-line records are joined in place, so memory stays around one chunk
+// plus the largest record no matter how big the file is.
+// Sequence lines before the first header (a bare sequence file) are returned as one
+// FASTA record with an empty name.
+class SequenceReader {
+public:
+    explicit SequenceReader(const std::string& filename, size_t chunk_size = 1 << 20);
+
+    bool is_open() const { return file.is_open(); }
+
+    // Move to the next record; false at end of file.
+    // Throws std::runtime_error on a truncated FASTQ record.
+    bool next(SequenceRecord& record);
+
+private:
+    std::ifstream file;
+    std::vector<char> buf;
+    size_t begin = 0, end = 0;   // unconsumed bytes are buf[begin, end)
+    bool eof = false;
+    bool started = false;        // a record was returned already
+
+    void refill();
+    bool read_line(size_t pos, size_t& len, size_t& next);
+};
+
+// All records of a file concatenated into one sequence (headers dropped).
+// Throws std::runtime_error if the file cannot be opened.
 std::string read_fasta_sequence(const std::string& filename);
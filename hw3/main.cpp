@@ -1,23 +1,41 @@
 #include "fasta_parser.hpp"
+#include "fasta_index.hpp"
 #include "align_sw.hpp"
 #include "align_sw_simd.hpp"
+#include "align_sw_lowmem.hpp"
+#include "align_sw_parallel.hpp"
+#include "align_sw_batch.hpp"
+#include "align_sw_banded.hpp"
+#include "align_sw_pairs.hpp"
 #include "align_sw_cuda.hpp" 
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 #include <string>
 #include <iomanip>
+#include <vector>
+#include <stdexcept>
 #include <sstream>
 
-void print_alignment(const AlignmentResult& result, size_t width = 60) {
-    std::cout << "optimal_alignment_score: " << result.score << "\n\n";
+// offset1 / offset2: position of seq1_full / seq2_full in their records (for --region1/2)
+void print_alignment(const AlignmentResult& result, const std::string& seq1_full, const std::string& seq2_full,
+                     size_t offset1 = 0, size_t offset2 = 0, size_t width = 60) {
+    std::cout << "optimal_alignment_score: " << result.score << "\n";
+    std::cout << "cigar: " << result.cigar_string() << "\n";
+    std::cout << "identity: " << std::fixed << std::setprecision(2) << result.identity() * 100 << "% ("
+              << result.matches << " matches, " << result.mismatches << " mismatches, "
+              << result.gaps << " gaps)\n\n";
+    std::cout.unsetf(std::ios::floatfield);
 
-    const std::string& seq1 = result.aligned_seq1;
-    const std::string& seq2 = result.aligned_seq2;
-    const std::string& match = result.match_line;
+    // The aligners only return a CIGAR; the gapped strings are built here for display
+    AlignedStrings aligned = render_alignment(result, seq1_full, seq2_full);
+    const std::string& seq1 = aligned.seq1;
+    const std::string& seq2 = aligned.seq2;
+    const std::string& match = aligned.match_line;
 
     size_t len = seq1.size();
-    size_t idx1 = result.start1;
-    size_t idx2 = result.start2;
+    size_t idx1 = offset1 + result.start1;
+    size_t idx2 = offset2 + result.start2;
 
     for (size_t i = 0; i < len; i += width) {
         size_t chunk_len = std::min(width, len - i);
@@ -45,43 +63,301 @@ void print_alignment(const AlignmentResult& result, size_t width = 60) {
     }
 }
 
+void print_score(const AlignmentScore& score, size_t offset1 = 0, size_t offset2 = 0) {
+    std::cout << "optimal_alignment_score: " << score.score << "\n";
+    std::cout << "end: Seq1 " << static_cast<long long>(offset1) + score.end1
+              << ", Seq2 " << static_cast<long long>(offset2) + score.end2 << "\n\n";
+}
+
+// Command line: two FASTA files plus optional "--name value" overrides.
+// --mode full   : full DP matrix + traceback (default)
+// --mode score  : score and end cell only, one rolling row
+// --mode linear : full alignment in O(m + n) memory (Hirschberg traceback)
+// --mode scan   : seq1 against every record of the second file (database search)
+// --mode banded : only the band --diagonal D (seq2 minus seq1 position) +- --band W,
+//                 stopping --xdrop X below the best (seed extension; -1 = whole band)
+// --mode pairs  : every record of file 1 against every record of file 2, or all-vs-all
+//                 within file 1 when it is the only file, on --threads workers
+// --region1/2   : align only "name:start-end" of that file, fetched through its .fai index
+// --threads N   : workers for the wavefront engine and --mode pairs (0 = all hardware threads)
+// --simd LEVEL  : SIMD instruction set, auto|sse2|sse4.1|avx2|avx512bw (default: $BIOPARALLEL_SIMD, else auto)
+struct CliOptions {
+    std::string file1, file2;
+    std::string region1, region2;
+    ScoringParams scoring;
+    std::string mode = "full";
+    unsigned threads = 0;
+    std::string simd = "auto";
+    BandParams band;
+};
+
+bool parse_args(int argc, char* argv[], CliOptions& opts) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            positional.push_back(arg);
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+        std::string text = argv[++i];
+        if (arg == "--mode") {
+            if (text != "full" && text != "score" && text != "linear" && text != "scan"
+                && text != "banded" && text != "pairs") return false;
+            opts.mode = text;
+            continue;
+        }
+        if (arg == "--simd") {
+            opts.simd = text;
+            continue;
+        }
+        if (arg == "--region1" || arg == "--region2") {
+            (arg == "--region1" ? opts.region1 : opts.region2) = text;
+            continue;
+        }
+
+        int value;
+        try {
+            value = std::stoi(text);
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        if (arg == "--match") opts.scoring.match = value;
+        else if (arg == "--mismatch") opts.scoring.mismatch = value;
+        else if (arg == "--gap") opts.scoring.gap_open = opts.scoring.gap_extend = value;
+        else if (arg == "--gap-open") opts.scoring.gap_open = value;
+        else if (arg == "--gap-extend") opts.scoring.gap_extend = value;
+        else if (arg == "--threads" && value >= 0) opts.threads = value;
+        else if (arg == "--diagonal") opts.band.diagonal = value;
+        else if (arg == "--band") opts.band.width = value;
+        else if (arg == "--xdrop") opts.band.xdrop = value;
+        else return false;
+    }
+    // All-vs-all pairs need only one file
+    if (positional.size() != 2 && !(opts.mode == "pairs" && positional.size() == 1)) return false;
+    // pairs aligns whole records, and scan every record of the second file
+    if ((opts.mode == "pairs" && (!opts.region1.empty() || !opts.region2.empty()))
+        || (opts.mode == "scan" && !opts.region2.empty())) {
+        std::cerr << "Error: --mode " << opts.mode << " does not take "
+                  << (opts.mode == "pairs" ? "--region1/--region2" : "--region2") << "\n";
+        return false;
+    }
+    opts.file1 = positional[0];
+    if (positional.size() == 2) opts.file2 = positional[1];
+    return true;
+}
+
+// Whole file through the streaming reader, or one region of it through the .fai index.
+// `offset` is where the returned sequence starts in its record.
+std::string load_sequence(const std::string& file, const std::string& region, size_t& offset) {
+    offset = 0;
+    if (region.empty())
+        return read_fasta_sequence(file);
+
+    IndexedFasta fasta(file);
+    FastaRegion r = fasta.resolve(region);
+    offset = r.start;
+    return fasta.fetch(r);
+}
+
+// Database scan: score and end cell of `query` against every record of `db_file`,
+// one target per SIMD lane, timed against the scalar score pass
+int run_scan(const std::string& query, size_t query_offset, const std::string& db_file,
+             const ScoringParams& scoring) {
+    std::vector<std::string> names, targets;
+    SequenceReader reader(db_file);
+    if (!reader.is_open()) throw std::runtime_error("cannot open " + db_file);
+    SequenceRecord record;
+    while (reader.next(record)) {
+        names.emplace_back(record.name);
+        targets.emplace_back(record.seq);
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<AlignmentScore> scalar_scores;
+    scalar_scores.reserve(targets.size());
+    for (const std::string& target : targets)
+        scalar_scores.push_back(smith_waterman_score(query, target, scoring));
+    auto end = std::chrono::high_resolution_clock::now();
+    double time_scalar = std::chrono::duration<double>(end - start).count();
+
+    auto start_batch = std::chrono::high_resolution_clock::now();
+    std::vector<AlignmentScore> scores = smith_waterman_batch_score(query, targets, scoring);
+    auto end_batch = std::chrono::high_resolution_clock::now();
+    double time_batch = std::chrono::duration<double>(end_batch - start_batch).count();
+
+    double cells = 0;
+    std::cout << "target\tscore\tquery_end\ttarget_end\n";
+    for (size_t t = 0; t < targets.size(); ++t) {
+        cells += static_cast<double>(query.size()) * targets[t].size();
+        std::cout << names[t] << "\t" << scores[t].score << "\t"
+                  << static_cast<long long>(query_offset) + scores[t].end1 << "\t" << scores[t].end2 << "\n";
+    }
+
+    size_t mismatched = 0;
+    for (size_t t = 0; t < targets.size(); ++t)
+        if (scalar_scores[t].score != scores[t].score) ++mismatched;
+
+    std::cout << "\n" << targets.size() << " targets, " << mismatched << " score mismatches vs scalar\n";
+    std::cout << "Batch SIMD (" << simd_level() << "): " << cells / time_batch / 1e9 << " GCUPS\n";
+    std::cout << "Speedup (vs Scalar): " << (time_scalar / time_batch) << "X\n";
+    return 0;
+}
+
+// Throughput mode: align many pairs of records, one pair per task, and print one line per
+// pair in input order while the later pairs are still running
+int run_pairs(const std::string& file1, const std::string& file2, const ScoringParams& scoring,
+              unsigned threads) {
+    auto read_records = [](const std::string& file, std::vector<std::string>& names,
+                           std::vector<std::string>& seqs) {
+        SequenceReader reader(file);
+        if (!reader.is_open()) throw std::runtime_error("cannot open " + file);
+        SequenceRecord record;
+        while (reader.next(record)) {
+            names.emplace_back(record.name);
+            seqs.emplace_back(record.seq);
+        }
+    };
+    std::vector<std::string> names1, seqs1, names2, seqs2;
+    read_records(file1, names1, seqs1);
+    bool all_vs_all = file2.empty();
+    if (!all_vs_all)
+        read_records(file2, names2, seqs2);
+    const std::vector<std::string>& other_names = all_vs_all ? names1 : names2;
+    const std::vector<std::string>& other_seqs = all_vs_all ? seqs1 : seqs2;
+
+    std::vector<SequencePair> pairs = all_vs_all ? all_vs_all_pairs(seqs1.size())
+                                                 : cross_pairs(seqs1.size(), seqs2.size());
+    double cells = 0;
+    for (const SequencePair& pair : pairs)
+        cells += static_cast<double>(seqs1[pair.first].size()) * other_seqs[pair.second].size();
+
+    std::cout << "seq1\tseq2\tscore\tstart1\tend1\tstart2\tend2\tidentity\tcigar\n";
+    // identity is printed as fixed-point; the stream gets its format back afterwards
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    auto start = std::chrono::high_resolution_clock::now();
+    align_pairs(seqs1, other_seqs, pairs, [&](size_t k, const AlignmentResult& r) {
+        std::cout << names1[pairs[k].first] << "\t" << other_names[pairs[k].second] << "\t" << r.score
+                  << "\t" << r.start1 << "\t" << r.end1 << "\t" << r.start2 << "\t" << r.end2 << "\t"
+                  << std::fixed << std::setprecision(2) << r.identity() * 100 << "\t" << r.cigar_string() << "\n";
+    }, scoring, threads);
+    auto end = std::chrono::high_resolution_clock::now();
+    double time_pairs = std::chrono::duration<double>(end - start).count();
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    std::cout << "\n" << pairs.size() << " pairs in " << time_pairs << " s, "
+              << cells / time_pairs / 1e9 << " GCUPS (SIMD " << simd_level() << ")\n";
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <seq1.fasta> <seq2.fasta>\n";
+    CliOptions opts;
+    if (const char* level = std::getenv("BIOPARALLEL_SIMD"))
+        opts.simd = level;
+    if (!parse_args(argc, argv, opts)) {
+        std::cerr << "Usage: " << argv[0] << " <seq1.fasta> [<seq2.fasta>]"
+                  << " [--mode full|score|linear|scan|banded|pairs] [--region1 name:start-end] [--region2 name:start-end]"
+                  << " [--threads N] [--simd auto|sse2|sse4.1|avx2|avx512bw]"
+                  << " [--diagonal D] [--band W] [--xdrop X]"
+                  << " [--match N] [--mismatch N] [--gap N | --gap-open N --gap-extend N]\n";
+        return 1;
+    }
+    if (!set_simd_level(opts.simd)) {
+        std::cerr << "Error: SIMD level '" << opts.simd << "' is unknown or not supported by this CPU\n";
         return 1;
     }
 
-    std::string seq1 = read_fasta_sequence(argv[1]);
-    std::string seq2 = read_fasta_sequence(argv[2]);
+    std::string seq1, seq2;
+    size_t offset1, offset2;
+    try {
+        if (opts.mode == "pairs")
+            return run_pairs(opts.file1, opts.file2, opts.scoring, opts.threads);
+        seq1 = load_sequence(opts.file1, opts.region1, offset1);
+        if (opts.mode == "scan")
+            return run_scan(seq1, offset1, opts.file2, opts.scoring);
+        seq2 = load_sequence(opts.file2, opts.region2, offset2);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
 
     // 標準 Scalar 計時
+    AlignmentResult result_scalar, result_simd;
+    AlignmentScore score_scalar, score_simd;
+
     auto start = std::chrono::high_resolution_clock::now();
-    AlignmentResult result_scalar = smith_waterman(seq1, seq2);
+    if (opts.mode == "score")
+        score_scalar = smith_waterman_score(seq1, seq2, opts.scoring);
+    else if (opts.mode == "linear")
+        result_scalar = smith_waterman_linear_space(seq1, seq2, opts.scoring);
+    else if (opts.mode == "banded")
+        result_scalar = smith_waterman_banded(seq1, seq2, opts.band, opts.scoring);
+    else
+        result_scalar = smith_waterman(seq1, seq2, opts.scoring);
     auto end = std::chrono::high_resolution_clock::now();
     double time_scalar = std::chrono::duration<double>(end - start).count();
 
     std::cout << "\nScalar Alignment:\n";
-    print_alignment(result_scalar);
+    if (opts.mode == "score") print_score(score_scalar, offset1, offset2);
+    else print_alignment(result_scalar, seq1, seq2, offset1, offset2);
 
     // SIMD 計時
     auto start_simd = std::chrono::high_resolution_clock::now();
-    AlignmentResult result_simd = smith_waterman_simd(seq1, seq2);
+    if (opts.mode == "score")
+        score_simd = smith_waterman_simd_score(seq1, seq2, opts.scoring);
+    else if (opts.mode == "linear")
+        result_simd = traceback_linear_space(seq1, seq2, smith_waterman_simd_score(seq1, seq2, opts.scoring), opts.scoring);
+    else if (opts.mode == "banded")
+        result_simd = smith_waterman_banded_simd(seq1, seq2, opts.band, opts.scoring);
+    else
+        result_simd = smith_waterman_simd(seq1, seq2, opts.scoring);
     auto end_simd = std::chrono::high_resolution_clock::now();
     double time_simd = std::chrono::duration<double>(end_simd - start_simd).count();
 
-    std::cout << "\nSIMD Alignment:\n";
-    print_alignment(result_simd);
+    std::cout << "\nSIMD Alignment (" << simd_level() << "):\n";
+    if (opts.mode == "score") print_score(score_simd, offset1, offset2);
+    else print_alignment(result_simd, seq1, seq2, offset1, offset2);
 
     std::cout << "\nSIMD Speedup (vs Scalar): " << (time_scalar / time_simd) << "X\n";
 
+    // The wavefront and CUDA engines always fill the whole matrix; nothing to compare a band against
+    if (opts.mode == "banded")
+        return 0;
+
+    // 多執行緒 wavefront 計時 (tiled striped kernel; traceback as in the SIMD run of this mode)
+    AlignmentResult result_parallel;
+    AlignmentScore score_parallel;
+    auto start_parallel = std::chrono::high_resolution_clock::now();
+    if (opts.mode == "score")
+        score_parallel = smith_waterman_parallel_score(seq1, seq2, opts.scoring, opts.threads);
+    else if (opts.mode == "linear")
+        result_parallel = traceback_linear_space(seq1, seq2, smith_waterman_parallel_score(seq1, seq2, opts.scoring, opts.threads), opts.scoring);
+    else
+        result_parallel = smith_waterman_parallel(seq1, seq2, opts.scoring, opts.threads);
+    auto end_parallel = std::chrono::high_resolution_clock::now();
+    double time_parallel = std::chrono::duration<double>(end_parallel - start_parallel).count();
+
+    std::cout << "\nParallel Wavefront Alignment:\n";
+    if (opts.mode == "score") print_score(score_parallel, offset1, offset2);
+    else print_alignment(result_parallel, seq1, seq2, offset1, offset2);
+
+    std::cout << "\nParallel Speedup (vs Scalar): " << (time_scalar / time_parallel) << "X\n";
+
+    // The CUDA engine keeps the whole H matrix on the device, so it only runs in full mode
+    if (opts.mode != "full")
+        return 0;
+
     // CUDA 計時
     auto start_cuda = std::chrono::high_resolution_clock::now();
-    AlignmentResult result_cuda = smith_waterman_cuda(seq1, seq2);
+    AlignmentResult result_cuda = smith_waterman_cuda(seq1, seq2, opts.scoring);
     auto end_cuda = std::chrono::high_resolution_clock::now();
     double time_cuda = std::chrono::duration<double>(end_cuda - start_cuda).count();
 
     std::cout << "\nCUDA Alignment:\n";
-    print_alignment(result_cuda);
+    print_alignment(result_cuda, seq1, seq2, offset1, offset2);
 
     std::cout << "\nCUDA Speedup (vs Scalar): " << (time_scalar / time_cuda) << "X\n";
     std::cout << "CUDA Speedup (vs SIMD): " << (time_simd / time_cuda) << "X\n";
@@ -0,0 +1,48 @@
+#include "seq_encode.hpp"
+#include <xsimd/xsimd.hpp>
+
+const std::array<uint8_t, 256> kBaseCode = [] {
+    std::array<uint8_t, 256> table;
+    table.fill(kBaseN);
+    table['A'] = table['a'] = 0;
+    table['C'] = table['c'] = 1;
+    table['G'] = table['g'] = 2;
+    table['T'] = table['t'] = 3;
+    return table;
+}();
+
+std::vector<uint8_t> encode_bases(const std::string& seq) {
+    using byte_batch = xsimd::batch<uint8_t>;
+    const size_t V = byte_batch::size;
+    const size_t n = seq.size();
+    std::vector<uint8_t> codes(n);
+    const uint8_t* text = reinterpret_cast<const uint8_t*>(seq.data());
+
+    // Clearing bit 5 folds a-z onto A-Z and maps no other byte onto A, C, G or T
+    const byte_batch fold(0xDF), code_n(kBaseN);
+    const byte_batch a('A'), c('C'), g('G'), t('T');
+    const byte_batch code_a(0), code_c(1), code_g(2), code_t(3);
+
+    size_t k = 0;
+    for (; k + V <= n; k += V) {
+        byte_batch v = byte_batch::load_unaligned(text + k) & fold;
+        byte_batch code = xsimd::select(v == t, code_t, code_n);
+        code = xsimd::select(v == g, code_g, code);
+        code = xsimd::select(v == c, code_c, code);
+        code = xsimd::select(v == a, code_a, code);
+        code.store_unaligned(codes.data() + k);
+    }
+    for (; k < n; ++k)
+        codes[k] = kBaseCode[text[k]];
+
+    return codes;
+}
+
+QueryProfile::QueryProfile(const std::vector<uint8_t>& query, const ScoringParams& params)
+    : length(query.size()), scores(kAlphabetSize * query.size()) {
+    for (uint8_t code = 0; code < kAlphabetSize; ++code) {
+        int* out = &scores[code * length];
+        for (size_t j = 0; j < length; ++j)
+            out[j] = bases_match(code, query[j]) ? params.match : params.mismatch;
+    }
+}
@@ -0,0 +1,232 @@
+#include "align_sw.hpp"
+#include "align_sw_simd.hpp"
+#include "align_sw_lowmem.hpp"
+#include "align_sw_parallel.hpp"
+#include "align_sw_banded.hpp"
+#include "align_sw_batch.hpp"
+#include "seq_encode.hpp"
+#include <climits>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Regression checks for the SIMD engines against the scalar Gotoh aligner.
+//   make check
+
+// `count` reproducible pairs of related DNA sequences, up to `max_len` long
+std::vector<std::pair<std::string, std::string>> make_pairs(int count, int max_len, unsigned seed) {
+    std::mt19937 rng(seed);
+    const char bases[] = "ACGT";
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int t = 0; t < count; ++t) {
+        std::string a, b;
+        int len = 1 + static_cast<int>(rng() % max_len);
+        for (int i = 0; i < len; ++i) a += bases[rng() % 4];
+        // b: a with point mutations, insertions and deletions
+        for (char c : a) {
+            unsigned r = rng() % 10;
+            if (r == 0) continue;
+            b += r == 1 ? bases[rng() % 4] : c;
+            if (r == 2) b += bases[rng() % 4];
+        }
+        pairs.emplace_back(a, b);
+    }
+    return pairs;
+}
+
+bool same_score(const AlignmentScore& got, const AlignmentScore& want) {
+    return got.score == want.score && (want.score == 0 || (got.end1 == want.end1 && got.end2 == want.end2));
+}
+
+// Schemes where opening a gap costs less than extending one (gap_open > gap_extend): a gap
+// gains by being closed and reopened, which the lazy-F loop of the striped kernel, in the SIMD
+// aligner and in every wavefront tile, cannot see.
+void test_cheap_gap_open() {
+    const ScoringParams schemes[] = {
+        {.match = 2, .mismatch = 0, .gap_open = 0, .gap_extend = -2},
+        {.match = 67, .mismatch = -2, .gap_open = -1, .gap_extend = -2},
+        {.match = 78, .mismatch = -3, .gap_open = -1, .gap_extend = -3},
+    };
+    for (const ScoringParams& p : schemes)
+        for (const auto& [a, b] : make_pairs(200, 120, 42)) {
+            AlignmentScore want = smith_waterman_score(a, b, p);
+            assert(same_score(smith_waterman_simd_score(a, b, p), want) && "SIMD score differs from scalar");
+
+            AlignmentResult full = smith_waterman_simd(a, b, p);
+            assert(same_score({full.score, full.end1, full.end2}, want) && "SIMD alignment differs from scalar");
+
+            assert(same_score(smith_waterman_parallel_score(a, b, p, 3), want) && "wavefront score differs from scalar");
+            AlignmentResult tiled = smith_waterman_parallel(a, b, p, 3);
+            assert(same_score({tiled.score, tiled.end1, tiled.end2}, want) && "wavefront alignment differs from scalar");
+        }
+    std::cout << "cheap gap open: OK" << std::endl;
+}
+
+// The SIMD aligner and the wavefront engine report the very alignment smith_waterman does, not
+// just one of the same score, so every engine prints the same CIGAR
+void test_same_alignment() {
+    const ScoringParams schemes[] = {
+        {},
+        {.match = 3, .mismatch = -2, .gap_open = -5, .gap_extend = -1},
+    };
+    for (const ScoringParams& p : schemes)
+        for (const auto& [a, b] : make_pairs(200, 300, 7)) {
+            AlignmentResult want = smith_waterman(a, b, p);
+            for (const AlignmentResult& got : {smith_waterman_simd(a, b, p), smith_waterman_parallel(a, b, p, 3)})
+                assert(got.score == want.score && got.start1 == want.start1 && got.start2 == want.start2
+                       && got.cigar_string() == want.cigar_string() && "engines disagree on the alignment");
+        }
+    std::cout << "same alignment: OK" << std::endl;
+}
+
+// Score of `r`'s CIGAR walked from its start cell; also checks that the walk ends at its end
+// cell and that every =/X column is what the bases say
+int rescore(const AlignmentResult& r, const std::string& a, const std::string& b, const ScoringParams& p) {
+    int i = r.start1, j = r.start2, score = 0;
+    for (const CigarOp& run : r.cigar) {
+        for (uint32_t k = 0; k < run.len; ++k) {
+            if (run.op == '=' || run.op == 'X') {
+                bool match = bases_match(encode_base(a[i]), encode_base(b[j]));
+                assert(match == (run.op == '=') && "CIGAR column disagrees with the bases");
+                score += match ? p.match : p.mismatch;
+                ++i, ++j;
+            } else {
+                score += k == 0 ? p.gap_open : p.gap_extend;
+                ++(run.op == 'D' ? i : j);
+            }
+        }
+    }
+    assert(i == r.end1 + 1 && j == r.end2 + 1 && "CIGAR does not end at the end cell");
+    return score;
+}
+
+// The linear-space aligner may pick another of the equal-score alignments than smith_waterman
+// (a different start and CIGAR), so its CIGAR is rescored instead of compared
+void test_linear_space() {
+    const ScoringParams schemes[] = {
+        {},
+        {.match = 3, .mismatch = -2, .gap_open = -6, .gap_extend = -1},
+        {.match = 1, .mismatch = -3, .gap_open = -3, .gap_extend = -3},
+    };
+    for (const ScoringParams& p : schemes)
+        for (const auto& [a, b] : make_pairs(200, 300, 21)) {
+            AlignmentResult want = smith_waterman(a, b, p);
+            AlignmentResult from_simd = traceback_linear_space(a, b, smith_waterman_simd_score(a, b, p), p);
+            for (const AlignmentResult& got : {smith_waterman_linear_space(a, b, p), from_simd}) {
+                assert(got.score == want.score && "linear-space score differs");
+                if (want.score == 0) continue;
+                assert(got.end1 == want.end1 && got.end2 == want.end2 && "linear-space end differs");
+                assert(rescore(got, a, b, p) == want.score && "linear-space CIGAR does not add up to the score");
+            }
+        }
+    std::cout << "linear space: OK" << std::endl;
+}
+
+// A band wider than the matrix is cut to it: the same result as no band, without rows
+// sized by the requested width
+void test_huge_band() {
+    for (const auto& [a, b] : make_pairs(20, 200, 3)) {
+        AlignmentScore want = smith_waterman_banded_score(a, b, BandParams {.width = -1});
+        for (int diagonal : {0, -150, INT_MAX / 2}) {
+            BandParams band {.diagonal = diagonal, .width = INT_MAX};
+            assert(same_score(smith_waterman_banded_score(a, b, band), want) && "huge band differs from no band");
+            assert(same_score(smith_waterman_banded_simd_score(a, b, band), want) && "huge SIMD band differs from no band");
+            AlignmentResult full = smith_waterman_banded(a, b, band);
+            assert(same_score({full.score, full.end1, full.end2}, want) && "huge band alignment differs");
+        }
+    }
+    std::cout << "huge band: OK" << std::endl;
+}
+
+// Narrow bands anywhere near the pair, with and without x-drop: the SIMD banded aligner
+// reports smith_waterman_banded's alignment (start, end and CIGAR through the reverse pass
+// and the box traceback), and both score-only passes agree with it
+void test_band() {
+    const ScoringParams schemes[] = {
+        {},
+        {.match = 2, .mismatch = -3, .gap_open = -2, .gap_extend = -2},
+        {.match = 3, .mismatch = -2, .gap_open = -5, .gap_extend = -1},
+        {.match = 1, .mismatch = -1, .gap_open = -3, .gap_extend = -1},
+    };
+    std::mt19937 rng(14);
+    for (const ScoringParams& p : schemes)
+        for (const auto& [a, b] : make_pairs(300, 250, 5)) {
+            int span = static_cast<int>(a.size() + b.size());
+            BandParams band {.diagonal = static_cast<int>(rng() % span) - static_cast<int>(a.size()),
+                             .width = static_cast<int>(rng() % 40),
+                             .xdrop = rng() % 2 ? -1 : static_cast<int>(rng() % 30)};
+            if (rng() % 2) band.diagonal = static_cast<int>(rng() % 21) - 10;   // near the true offset
+
+            AlignmentResult want = smith_waterman_banded(a, b, band, p);
+            AlignmentResult got = smith_waterman_banded_simd(a, b, band, p);
+            assert(got.score == want.score && "banded SIMD score differs");
+            assert((want.score == 0 || (got.start1 == want.start1 && got.start2 == want.start2
+                                        && got.end1 == want.end1 && got.end2 == want.end2
+                                        && got.cigar_string() == want.cigar_string()))
+                   && "banded SIMD alignment differs");
+
+            AlignmentScore score = smith_waterman_banded_score(a, b, band, p);
+            assert(same_score(score, {want.score, want.end1, want.end2}) && "banded score pass differs");
+            assert(same_score(smith_waterman_banded_simd_score(a, b, band, p), score) && "banded SIMD score pass differs");
+        }
+    std::cout << "narrow band: OK" << std::endl;
+}
+
+// One SIMD level of test_batch
+void test_batch_level() {
+    const ScoringParams schemes[] = {
+        {},
+        {.match = 3, .mismatch = -2, .gap_open = -5, .gap_extend = -1},
+        {.match = 2, .mismatch = 0, .gap_open = 0, .gap_extend = -2},
+    };
+    std::mt19937 rng(11);
+    const char bases[] = "ACGTNacgtRY";
+    for (const ScoringParams& p : schemes)
+        for (int count : {1, 7, 33, 100}) {
+            auto pairs = make_pairs(count, 300, 100 + count);
+            const std::string& query = pairs[0].first;
+            std::vector<std::string> targets;
+            for (int t = 0; t < count; ++t) {
+                std::string target = pairs[t].second;
+                switch (rng() % 6) {
+                case 0: target.clear(); break;
+                case 1: for (char& c : target) if (rng() % 8 == 0) c = bases[rng() % 11]; break;
+                case 2: target = query.substr(0, query.size() / 2) + query.substr(0, query.size() / 2); break;
+                }
+                targets.push_back(target);
+            }
+            std::vector<AlignmentScore> got = smith_waterman_batch_score(query, targets, p);
+            assert(got.size() == targets.size());
+            for (size_t t = 0; t < targets.size(); ++t) {
+                AlignmentScore want = smith_waterman_score(query, targets[t], p);
+                assert(got[t].score == want.score && got[t].end1 == want.end1 && got[t].end2 == want.end2
+                       && "batch scan differs from scalar");
+            }
+        }
+}
+
+// The batch scan gives every target exactly smith_waterman_score's result, end cells
+// included: target counts that leave pad lanes in the last batch, empty targets, N and
+// IUPAC bases, scores past 8 bits, and repeats whose tied maxima must resolve as the scalar row-major scan does.
+// Run at every SIMD level the CPU has, since each has its own lane count.
+void test_batch() {
+    for (const char* level : {"sse2", "sse4.1", "avx2", "avx512bw"}) {
+        if (!set_simd_level(level)) continue;
+        test_batch_level();
+    }
+    set_simd_level("auto");
+    std::cout << "batch scan: OK" << std::endl;
+}
+
+int main() {
+    test_cheap_gap_open();
+    test_same_alignment();
+    test_linear_space();
+    test_huge_band();
+    test_band();
+    test_batch();
+    std::cout << "All tests passed" << std::endl;
+    return 0;
+}
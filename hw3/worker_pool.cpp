@@ -0,0 +1,64 @@
+#include "worker_pool.hpp"
+
+namespace {
+
+// Set while this thread runs a body, on the workers and on the thread that called run()
+thread_local bool in_body = false;
+
+} // namespace
+
+WorkerPool& WorkerPool::shared() {
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void WorkerPool::run(unsigned threads, const std::function<void()>& body) {
+    if (in_body || threads <= 1) {
+        body();
+        return;
+    }
+
+    std::lock_guard<std::mutex> turn(run_mutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (workers.size() + 1 < threads)
+            workers.emplace_back(&WorkerPool::loop, this, workers.size());
+        job = &body;
+        wanted = threads - 1;
+        running = wanted;
+        ++generation;
+    }
+    wake.notify_all();
+    in_body = true;
+    body();
+    in_body = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return running == 0; });
+    job = nullptr;
+}
+
+void WorkerPool::loop(size_t index) {
+    in_body = true;
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stop || generation != seen; });
+        if (stop) return;
+        seen = generation;
+        if (index >= wanted) continue;   // not needed this time
+        const std::function<void()>* body = job;
+        lock.unlock();
+        (*body)();
+        lock.lock();
+        if (--running == 0) finished.notify_all();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Worker threads kept from one parallel call to the next, shared by the pairs driver and the
+// wavefront engine, so a driver that runs many small batches or alignments does not pay for
+// thread creation each time. run(threads, body) runs body() on the calling thread and
+// threads - 1 workers and returns when every copy has returned; the pool grows to the largest
+// count asked for. Calls from several threads take turns. A run() from inside a body (one
+// engine nested in another) runs body() once on the calling thread instead of waiting for
+// workers that are all busy.
+class WorkerPool {
+public:
+    static WorkerPool& shared();
+
+    ~WorkerPool();
+
+    void run(unsigned threads, const std::function<void()>& body);
+
+private:
+    void loop(size_t index);
+
+    std::mutex run_mutex;               // one run() at a time
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::vector<std::thread> workers;
+    const std::function<void()>* job = nullptr;
+    size_t wanted = 0;                  // workers [0, wanted) take part in the current run
+    size_t running = 0;                 // of those, the ones still in body()
+    uint64_t generation = 0;
+    bool stop = false;
+};